@@ -0,0 +1,194 @@
+#include "Analysis.h"
+
+int pieceValue(Piece::Type type) noexcept {
+    switch (type) {
+        case Piece::Type::PAWN: return 100;
+        case Piece::Type::KNIGHT: return 320;
+        case Piece::Type::BISHOP: return 330;
+        case Piece::Type::ROOK: return 500;
+        case Piece::Type::QUEEN: return 900;
+        case Piece::Type::KING: return 20000;
+    }
+    return 0;
+}
+
+/// Square index of the least valuable piece of `colour` attacking `target` on `mailbox`, if any.
+/// Pieces removed from the mailbox no longer block, which is what uncovers x-ray attackers.
+static std::optional<gsl::index> findLeastValuableAttacker(const Board::Mailbox& mailbox, gsl::index target, Piece::Colour colour) noexcept {
+    const gsl::index rowLength = Location::getMaxColumnIndex() + 1;
+    const gsl::index targetRow = target / rowLength;
+    const gsl::index targetColumn = target % rowLength;
+
+    std::optional<gsl::index> best;
+    int bestValue = 0;
+    auto consider = [&](gsl::index row, gsl::index column, auto&& isRightType) {
+        if (row < 0 || row > Location::getMaxRowIndex() || column < 0 || column > Location::getMaxColumnIndex()) return;
+        const gsl::index square = row * rowLength + column;
+        const Piece* piece = mailbox[square];
+        if (piece == nullptr || piece->getColour() != colour || !isRightType(piece->getType())) return;
+        if (!best.has_value() || pieceValue(piece->getType()) < bestValue) {
+            best = square;
+            bestValue = pieceValue(piece->getType());
+        }
+    };
+
+    // pawns capture towards the opponent's back row, so look one row behind the target (from the pawn's side)
+    const gsl::index pawnRow = targetRow + (colour == Piece::Colour::WHITE ? -1 : 1);
+    for (const gsl::index columnOffset : {-1, 1}) {
+        consider(pawnRow, targetColumn + columnOffset, [](Piece::Type t) { return t == Piece::Type::PAWN; });
+    }
+
+    for (const auto& [rowOffset, columnOffset] : {std::pair{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}) {
+        consider(targetRow + rowOffset, targetColumn + columnOffset, [](Piece::Type t) { return t == Piece::Type::KNIGHT; });
+    }
+
+    for (gsl::index rowStep = -1; rowStep <= 1; ++rowStep) {
+        for (gsl::index columnStep = -1; columnStep <= 1; ++columnStep) {
+            if (rowStep == 0 && columnStep == 0) continue;
+            const bool isDiagonalRay = (rowStep != 0 && columnStep != 0);
+
+            consider(targetRow + rowStep, targetColumn + columnStep, [](Piece::Type t) { return t == Piece::Type::KING; });
+
+            // first piece along the ray is the only one that can attack along it
+            gsl::index row = targetRow + rowStep;
+            gsl::index column = targetColumn + columnStep;
+            for (; row >= 0 && row <= Location::getMaxRowIndex() && column >= 0 && column <= Location::getMaxColumnIndex();
+                   row += rowStep, column += columnStep) {
+                if (mailbox[row * rowLength + column] == nullptr) continue;
+                consider(row, column, [&](Piece::Type t) {
+                    return t == Piece::Type::QUEEN || t == (isDiagonalRay ? Piece::Type::BISHOP : Piece::Type::ROOK);
+                });
+                break;
+            }
+        }
+    }
+
+    return best;
+}
+
+int staticExchangeEvaluation(const Game& game, const Location& source, const Location& destination) noexcept {
+    Board::Mailbox mailbox = game.getBoard().calcMailbox();
+    const gsl::index target = destination.getSquareIndex();
+    const Piece* attacker = mailbox[source.getSquareIndex()];
+    if (attacker == nullptr) return 0;
+
+    // gains[d] = material won by the side making capture d, if the sequence were to stop there
+    std::array<int, 32> gains {};
+    gsl::index depth = 0;
+
+    const bool isEnPassantCapture = attacker->getType() == Piece::Type::PAWN
+            && mailbox[target] == nullptr
+            && game.getEnPassantTargetSquare() == Location{source.getBoardRowIndex().value(), destination.getBoardColumnIndex().value()};
+    if (isEnPassantCapture) {
+        gains[0] = pieceValue(Piece::Type::PAWN);
+        mailbox[game.getEnPassantTargetSquare().getSquareIndex()] = nullptr;
+    } else {
+        gains[0] = (mailbox[target] != nullptr ? pieceValue(mailbox[target]->getType()) : 0);
+    }
+
+    Piece::Colour sideToCapture = attacker->getColour();
+    gsl::index attackerSquare = source.getSquareIndex();
+    while (true) {
+        // `attacker` now stands on the target square
+        const int valueOnTarget = pieceValue(attacker->getType());
+        mailbox[attackerSquare] = nullptr;
+        mailbox[target] = attacker;
+        sideToCapture = (sideToCapture == Piece::Colour::WHITE ? Piece::Colour::BLACK : Piece::Colour::WHITE);
+
+        const auto nextAttackerSquare = findLeastValuableAttacker(mailbox, target, sideToCapture);
+        if (!nextAttackerSquare.has_value() || depth + 1 >= static_cast<gsl::index>(gains.size())) break;
+
+        // the king may only recapture if nothing can take it back
+        const Piece* nextAttacker = mailbox[*nextAttackerSquare];
+        if (nextAttacker->getType() == Piece::Type::KING) {
+            Board::Mailbox afterKingCapture = mailbox;
+            afterKingCapture[*nextAttackerSquare] = nullptr;
+            afterKingCapture[target] = nextAttacker;
+            const Piece::Colour otherSide = (sideToCapture == Piece::Colour::WHITE ? Piece::Colour::BLACK : Piece::Colour::WHITE);
+            if (findLeastValuableAttacker(afterKingCapture, target, otherSide).has_value()) break;
+        }
+
+        ++depth;
+        gains[depth] = valueOnTarget - gains[depth - 1];
+        attacker = nextAttacker;
+        attackerSquare = *nextAttackerSquare;
+    }
+
+    // each side may decline to recapture, so fold the sequence back from its end
+    for (; depth > 0; --depth) {
+        gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+    }
+    return gains[0];
+}
+
+std::uint64_t AttackMap::calcAttackedSquares(Piece::Colour colour) const noexcept {
+    std::uint64_t squares = 0;
+    for (gsl::index squareIndex = 0; squareIndex < Location::getSquareCount(); ++squareIndex) {
+        if (getCount(squareIndex, colour) > 0) squares |= std::uint64_t{1} << squareIndex;
+    }
+    return squares;
+}
+
+AttackMap calcAttackMap(const Board& board) noexcept {
+    const Board::Mailbox mailbox = board.calcMailbox();
+    const gsl::index rowLength = Location::getMaxColumnIndex() + 1;
+    auto isOnBoard = [](gsl::index row, gsl::index column) {
+        return row >= 0 && row <= Location::getMaxRowIndex() && column >= 0 && column <= Location::getMaxColumnIndex();
+    };
+
+    AttackMap attackMap;
+    for (gsl::index square = 0; square < Location::getSquareCount(); ++square) {
+        const Piece* piece = mailbox[square];
+        if (piece == nullptr) continue;
+        const Piece::Colour colour = piece->getColour();
+        const gsl::index row = square / rowLength;
+        const gsl::index column = square % rowLength;
+
+        auto attackStep = [&](gsl::index rowOffset, gsl::index columnOffset) {
+            if (isOnBoard(row + rowOffset, column + columnOffset)) {
+                attackMap.addAttack((row + rowOffset) * rowLength + column + columnOffset, colour);
+            }
+        };
+        auto attackRay = [&](gsl::index rowStep, gsl::index columnStep) {
+            for (gsl::index r = row + rowStep, c = column + columnStep; isOnBoard(r, c); r += rowStep, c += columnStep) {
+                attackMap.addAttack(r * rowLength + c, colour);
+                if (mailbox[r * rowLength + c] != nullptr) break;
+            }
+        };
+
+        switch (piece->getType()) {
+            case Piece::Type::PAWN: {
+                const gsl::index forward = (colour == Piece::Colour::WHITE ? 1 : -1);
+                attackStep(forward, -1);
+                attackStep(forward, 1);
+                break;
+            }
+            case Piece::Type::KNIGHT:
+                for (const auto& [rowOffset, columnOffset] : {std::pair{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}) {
+                    attackStep(rowOffset, columnOffset);
+                }
+                break;
+            case Piece::Type::KING:
+                for (gsl::index rowOffset = -1; rowOffset <= 1; ++rowOffset) {
+                    for (gsl::index columnOffset = -1; columnOffset <= 1; ++columnOffset) {
+                        if (rowOffset != 0 || columnOffset != 0) attackStep(rowOffset, columnOffset);
+                    }
+                }
+                break;
+            case Piece::Type::BISHOP:
+            case Piece::Type::ROOK:
+            case Piece::Type::QUEEN:
+                for (gsl::index rowStep = -1; rowStep <= 1; ++rowStep) {
+                    for (gsl::index columnStep = -1; columnStep <= 1; ++columnStep) {
+                        if (rowStep == 0 && columnStep == 0) continue;
+                        const bool isDiagonalRay = (rowStep != 0 && columnStep != 0);
+                        if (piece->getType() == Piece::Type::QUEEN || isDiagonalRay == (piece->getType() == Piece::Type::BISHOP)) {
+                            attackRay(rowStep, columnStep);
+                        }
+                    }
+                }
+                break;
+        }
+    }
+    return attackMap;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Game.h"
+
+/// Material value of a piece type in centipawns, as used by the analysis functions below
+[[nodiscard]] int pieceValue(Piece::Type type) noexcept;
+
+/** Static exchange evaluation: the material balance (in centipawns, from the point of view of the piece at `source`)
+ * once every capture on `destination` has been played out, each side always recapturing with its least valuable
+ * attacker and stopping as soon as continuing would lose material. Sliders behind the capturing pieces (x-rays) join
+ * in as the line opens up.
+ *
+ * NB: Pins and checks are ignored, so this is an estimate for move ordering / blunder warnings, not a legality check.
+ */
+[[nodiscard]] int staticExchangeEvaluation(const Game& game, const Location& source, const Location& destination) noexcept;
+
+/// How many pieces of each colour attack each square, packed one byte per square (white count in the low nibble,
+/// black in the high nibble, both saturating at 15)
+class AttackMap {
+    /// DATA MEMBERS
+    std::array<std::uint8_t, Location::getSquareCount()> counts {};
+
+public:
+    /// GETTERS
+    [[nodiscard]] int getCount(gsl::index squareIndex, Piece::Colour colour) const noexcept {
+        return (colour == Piece::Colour::WHITE ? counts[squareIndex] & 0xF : counts[squareIndex] >> 4);
+    }
+    [[nodiscard]] int getCount(const Location& location, Piece::Colour colour) const { return getCount(location.getSquareIndex(), colour); }
+    [[nodiscard]] std::uint64_t calcAttackedSquares(Piece::Colour colour) const noexcept; // as a square set
+
+    /// MISC.
+    void addAttack(gsl::index squareIndex, Piece::Colour colour) noexcept {
+        const int shift = (colour == Piece::Colour::WHITE ? 0 : 4);
+        if (((counts[squareIndex] >> shift) & 0xF) != 0xF) {
+            counts[squareIndex] += static_cast<std::uint8_t>(1 << shift);
+        }
+    }
+};
+
+/** Every square each piece attacks, ie. could capture on if an enemy piece stood there, for both colours in one pass.
+ * Squares with a piece of the same colour count too (they're defended), and a slider's line stops at the first piece.
+ *
+ * NB: Like staticExchangeEvaluation(), pins are ignored.
+ */
+[[nodiscard]] AttackMap calcAttackMap(const Board& board) noexcept;
@@ -0,0 +1,420 @@
+#include "AnalysisCoordinator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr std::size_t workerTableBytes = std::size_t{16} << 20; // per worker Perft table
+
+// "<port>" = 127.0.0.1:<port>, "<IPv4 address>:<port>", otherwise a Unix socket path
+static int openSocket(std::string_view address, bool isListening) {
+    const auto isDigits = [](std::string_view str) {
+        return !str.empty() && std::all_of(str.begin(), str.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+    };
+    const std::size_t colon = address.rfind(':');
+    const bool isTcp = isDigits(address) || (colon != std::string_view::npos && isDigits(address.substr(colon + 1)));
+
+    const int fd = socket(isTcp ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::format("socket failed: {}", std::strerror(errno)));
+    }
+
+    int result;
+    if (isTcp) {
+        const std::string_view port = (colon == std::string_view::npos ? address : address.substr(colon + 1));
+        sockaddr_in socketAddress {};
+        socketAddress.sin_family = AF_INET;
+        socketAddress.sin_port = htons(static_cast<std::uint16_t>(std::stoi(std::string{port})));
+        socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (colon != std::string_view::npos && inet_pton(AF_INET, std::string{address.substr(0, colon)}.c_str(), &socketAddress.sin_addr) != 1) {
+            close(fd);
+            throw std::invalid_argument(std::format("Invalid IPv4 address in '{}'", address));
+        }
+        if (isListening) {
+            const int reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            result = bind(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+        } else {
+            result = connect(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+        }
+    } else {
+        sockaddr_un socketAddress {};
+        socketAddress.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(socketAddress.sun_path)) {
+            close(fd);
+            throw std::invalid_argument("Unix socket path too long");
+        }
+        std::copy(address.begin(), address.end(), socketAddress.sun_path);
+        if (isListening) {
+            unlink(socketAddress.sun_path);
+            result = bind(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+        } else {
+            result = connect(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+        }
+    }
+
+    if (result < 0 || (isListening && ::listen(fd, SOMAXCONN) < 0)) {
+        const std::string reason = std::strerror(errno);
+        close(fd);
+        throw std::runtime_error(std::format("Cannot {} '{}': {}", (isListening ? "listen on" : "connect to"), address, reason));
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const void* data, std::size_t size) noexcept {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* data, std::size_t size) noexcept {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t bytesRead = read(fd, bytes, size);
+        if (bytesRead < 0 && errno == EINTR) continue;
+        if (bytesRead <= 0) return false;
+        bytes += bytesRead;
+        size -= static_cast<std::size_t>(bytesRead);
+    }
+    return true;
+}
+
+/// CONSTRUCTORS
+
+AnalysisCoordinator::~AnalysisCoordinator() {
+    for (const Worker& worker : workers) {
+        closeWorker(worker);
+    }
+    if (listeningFd >= 0) {
+        close(listeningFd);
+    }
+}
+
+/// WORKERS
+
+void AnalysisCoordinator::spawnWorkers(unsigned count) {
+    for (unsigned i = 0; i < count; ++i) {
+        std::array<int, 2> fds {};
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()) < 0) {
+            throw std::runtime_error(std::format("socketpair failed: {}", std::strerror(errno)));
+        }
+        const pid_t pid = fork();
+        if (pid < 0) {
+            const std::string reason = std::strerror(errno);
+            close(fds[0]);
+            close(fds[1]);
+            throw std::runtime_error(std::format("fork failed: {}", reason));
+        }
+        if (pid == 0) {
+            // without exec, CLOEXEC doesn't apply: let go of every other connection so each worker's hang-up is seen
+            close(fds[0]);
+            for (const Worker& worker : workers) {
+                close(worker.fd);
+            }
+            if (listeningFd >= 0) {
+                close(listeningFd);
+            }
+            try {
+                serveWorker(fds[1]);
+            } catch (...) {
+                _exit(EXIT_FAILURE);
+            }
+            _exit(EXIT_SUCCESS); // no destructors or atexit handlers: they belong to the coordinator
+        }
+        close(fds[1]);
+        workers.push_back(Worker{.fd = fds[0], .pid = pid});
+    }
+}
+
+void AnalysisCoordinator::listen(std::string_view address) {
+    const int fd = openSocket(address, true);
+    if (listeningFd >= 0) {
+        close(listeningFd);
+    }
+    listeningFd = fd;
+}
+
+void AnalysisCoordinator::acceptWorker() noexcept {
+    const int fd = accept4(listeningFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd >= 0) {
+        workers.push_back(Worker{.fd = fd});
+    }
+}
+
+void AnalysisCoordinator::closeWorker(const Worker& worker) noexcept {
+    close(worker.fd);
+    if (worker.pid > 0) {
+        kill(worker.pid, SIGKILL); // it may be mid-unit, and its answer is no longer wanted
+        waitpid(worker.pid, nullptr, 0);
+    }
+}
+
+/// JOBS
+
+std::vector<std::uint64_t> AnalysisCoordinator::run(std::span<const WorkUnit> units) {
+    Run run {
+        .id = ++runCount,
+        .units = units,
+        .answers = std::vector<std::uint64_t>(units.size()),
+        .isAnswered = std::vector<bool>(units.size()),
+        .copiesInFlight = std::vector<std::uint8_t>(units.size()),
+    };
+    for (std::uint32_t i = 0; i < units.size(); ++i) {
+        run.unassigned.push_back(i);
+    }
+
+    std::vector<pollfd> pollFds;
+    while (run.answeredCount < units.size()) {
+        dispatch(run);
+        dropLostWorkers(run);
+        if (workers.empty() && listeningFd < 0) {
+            throw std::runtime_error(std::format("Every analysis worker was lost with {} of {} units unanswered",
+                                                 units.size() - run.answeredCount, units.size()));
+        }
+
+        // with everything handed out and a worker idle, wake up in time to back up the oldest unit if it straggles
+        int timeoutMs = -1;
+        const bool isAnyWorkerIdle = std::any_of(workers.begin(), workers.end(), [](const Worker& worker) { return worker.assignments.empty(); });
+        if (run.unassigned.empty() && isAnyWorkerIdle) {
+            const Clock::time_point now = Clock::now();
+            Clock::duration untilStraggling = Clock::duration::max();
+            for (const Worker& worker : workers) {
+                for (const Worker::Assignment& assignment : worker.assignments) {
+                    if (assignment.runId != run.id || run.isAnswered[assignment.unitIndex] || run.copiesInFlight[assignment.unitIndex] > 1) continue;
+                    untilStraggling = std::min(untilStraggling, assignment.sentAt + calcStraggleTime(run) - now);
+                }
+            }
+            if (untilStraggling != Clock::duration::max()) {
+                timeoutMs = static_cast<int>(std::clamp<std::int64_t>(std::chrono::ceil<std::chrono::milliseconds>(untilStraggling).count(), 1, 1000));
+            }
+        }
+
+        pollFds.clear();
+        for (const Worker& worker : workers) {
+            pollFds.push_back(pollfd{.fd = worker.fd, .events = POLLIN, .revents = 0});
+        }
+        if (listeningFd >= 0) {
+            pollFds.push_back(pollfd{.fd = listeningFd, .events = POLLIN, .revents = 0});
+        }
+        if (poll(pollFds.data(), pollFds.size(), timeoutMs) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::format("poll failed: {}", std::strerror(errno)));
+        }
+
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            if (pollFds[i].revents != 0) {
+                receive(workers[i], run);
+            }
+        }
+        if (listeningFd >= 0 && (pollFds.back().revents & POLLIN) != 0) {
+            acceptWorker();
+        }
+        dropLostWorkers(run);
+    }
+    return std::move(run.answers);
+}
+
+Perft::Result AnalysisCoordinator::perft(const GameController& controller, int depth) {
+    if (depth < 3) {
+        return Perft{std::size_t{1} << 16}.run(controller, depth, 1);
+    }
+    if (depth - 2 > 0xFF) {
+        throw std::invalid_argument(std::format("Perft depth {} is too deep to distribute", depth));
+    }
+
+    // one unit per second-ply position, as Perft::run() splits for its threads
+    GameController root {controller};
+    const Game::PackedPosition rootPosition = root.getGame().takeSnapshot();
+    const MoveList rootMoves = root.calcLegalMoves();
+    std::vector<WorkUnit> units;
+    std::vector<std::size_t> rootMoveIndices;
+    for (std::size_t i = 0; i < rootMoves.size(); ++i) {
+        root.restorePosition(rootPosition);
+        root.applyMoveUnchecked(rootMoves[i]);
+        const Game::PackedPosition replyPosition = root.getGame().takeSnapshot();
+        for (const Move& reply : root.calcLegalMoves()) {
+            root.restorePosition(replyPosition);
+            root.applyMoveUnchecked(reply);
+            units.push_back(WorkUnit{.position = root.getGame().takeSnapshot(), .kind = WorkUnit::Kind::PERFT, .depth = static_cast<std::uint8_t>(depth - 2)});
+            rootMoveIndices.push_back(i);
+        }
+    }
+
+    const std::vector<std::uint64_t> answers = run(units);
+    Perft::Result result;
+    for (const Move& move : rootMoves) {
+        result.divide.emplace_back(move, 0);
+    }
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        result.divide[rootMoveIndices[i]].second += answers[i];
+        result.nodes += answers[i];
+    }
+    return result;
+}
+
+std::vector<Game::GameState> AnalysisCoordinator::classify(std::span<const Game::PackedPosition> positions) {
+    std::vector<WorkUnit> units;
+    units.reserve(positions.size());
+    for (const Game::PackedPosition& position : positions) {
+        units.push_back(WorkUnit{.position = position, .kind = WorkUnit::Kind::CLASSIFY});
+    }
+
+    const std::vector<std::uint64_t> answers = run(units);
+    std::vector<Game::GameState> states;
+    states.reserve(answers.size());
+    for (const std::uint64_t answer : answers) {
+        states.push_back(static_cast<Game::GameState>(answer));
+    }
+    return states;
+}
+
+void AnalysisCoordinator::dispatch(Run& run) {
+    // fill every worker's pipeline, in turn, so the units go out round robin
+    bool isAssigning = true;
+    while (isAssigning && !run.unassigned.empty()) {
+        isAssigning = false;
+        for (Worker& worker : workers) {
+            while (!worker.isLost && !run.unassigned.empty() && run.isAnswered[run.unassigned.front()]) {
+                run.unassigned.pop_front();
+            }
+            if (worker.isLost || run.unassigned.empty() || worker.assignments.size() >= settings.unitsPerWorker) continue;
+            const std::uint32_t unitIndex = run.unassigned.front();
+            run.unassigned.pop_front();
+            isAssigning = assign(worker, run, unitIndex) || isAssigning;
+        }
+    }
+    if (!run.unassigned.empty()) return;
+
+    // back up stragglers: the oldest unanswered unit (with only one copy out) that has gone on too long goes to an
+    // idle worker too. It's still worth keeping the original copy, as it may well finish first
+    const Clock::time_point now = Clock::now();
+    const Clock::duration straggleTime = calcStraggleTime(run);
+    for (Worker& idle : workers) {
+        if (idle.isLost || !idle.assignments.empty()) continue;
+
+        const Worker::Assignment* oldest = nullptr;
+        for (const Worker& worker : workers) {
+            for (const Worker::Assignment& assignment : worker.assignments) {
+                const bool isStraggling = assignment.runId == run.id && !run.isAnswered[assignment.unitIndex]
+                        && run.copiesInFlight[assignment.unitIndex] == 1 && now - assignment.sentAt >= straggleTime;
+                if (isStraggling && (oldest == nullptr || assignment.sentAt < oldest->sentAt)) {
+                    oldest = &assignment;
+                }
+            }
+        }
+        if (oldest == nullptr) return;
+        assign(idle, run, oldest->unitIndex);
+    }
+}
+
+bool AnalysisCoordinator::assign(Worker& worker, Run& run, std::uint32_t unitIndex) noexcept {
+    const WorkUnit& unit = run.units[unitIndex];
+    const Request request {.runId = run.id, .unitIndex = unitIndex, .kind = unit.kind, .depth = unit.depth, .position = unit.position};
+    // recorded first, so a unit sent to a worker that turns out to be lost is handed out again with the rest
+    worker.assignments.push_back(Worker::Assignment{.runId = run.id, .unitIndex = unitIndex, .sentAt = Clock::now()});
+    ++run.copiesInFlight[unitIndex];
+    if (!sendAll(worker.fd, &request, sizeof(request))) {
+        worker.isLost = true;
+    }
+    return !worker.isLost;
+}
+
+AnalysisCoordinator::Clock::duration AnalysisCoordinator::calcStraggleTime(const Run& run) const noexcept {
+    if (run.answeredCount == 0) return settings.minStraggleTime;
+    const Clock::duration meanUnitTime = run.totalUnitTime / static_cast<Clock::rep>(run.answeredCount);
+    return std::max(settings.minStraggleTime, meanUnitTime * settings.straggleFactor);
+}
+
+void AnalysisCoordinator::receive(Worker& worker, Run& run) {
+    std::array<char, 4096> chunk {};
+    const ssize_t bytesRead = read(worker.fd, chunk.data(), chunk.size());
+    if (bytesRead < 0 && errno == EINTR) return;
+    if (bytesRead <= 0) {
+        worker.isLost = true;
+        return;
+    }
+    worker.inbound.append(chunk.data(), static_cast<std::size_t>(bytesRead));
+
+    std::size_t offset = 0;
+    for (; worker.inbound.size() - offset >= sizeof(Response); offset += sizeof(Response)) {
+        Response response {};
+        std::memcpy(&response, worker.inbound.data() + offset, sizeof(response));
+
+        const auto assignment = std::find_if(worker.assignments.begin(), worker.assignments.end(), [&](const Worker::Assignment& a) {
+            return a.runId == response.runId && a.unitIndex == response.unitIndex;
+        });
+        if (assignment == worker.assignments.end()) { // not something it was asked, so it can't be trusted further
+            worker.isLost = true;
+            return;
+        }
+        const Clock::duration unitTime = Clock::now() - assignment->sentAt;
+        worker.assignments.erase(assignment);
+        if (response.runId != run.id) continue; // a late answer to an earlier run
+
+        --run.copiesInFlight[response.unitIndex];
+        if (run.isAnswered[response.unitIndex]) continue; // the other copy of a backed up unit won
+        run.isAnswered[response.unitIndex] = true;
+        run.answers[response.unitIndex] = response.answer;
+        ++run.answeredCount;
+        run.totalUnitTime += unitTime;
+    }
+    worker.inbound.erase(0, offset);
+}
+
+void AnalysisCoordinator::dropLostWorkers(Run& run) noexcept {
+    for (const Worker& worker : workers) {
+        if (!worker.isLost) continue;
+        // back to the front of the queue, so they aren't left until last
+        for (auto assignment = worker.assignments.rbegin(); assignment != worker.assignments.rend(); ++assignment) {
+            if (assignment->runId != run.id) continue;
+            if (--run.copiesInFlight[assignment->unitIndex] == 0 && !run.isAnswered[assignment->unitIndex]) {
+                run.unassigned.push_front(assignment->unitIndex);
+            }
+        }
+        closeWorker(worker);
+    }
+    std::erase_if(workers, [](const Worker& worker) { return worker.isLost; });
+}
+
+/// WORKER SIDE
+
+void AnalysisCoordinator::serveWorker(int fd) {
+    GameController controller {new GameViewNone};
+    Perft perft {workerTableBytes}; // kept across units: neighbouring second-ply positions share many subtrees
+    Request request {};
+    while (readAll(fd, &request, sizeof(request))) {
+        const Response response {.runId = request.runId, .unitIndex = request.unitIndex, .answer = answer(controller, perft, request)};
+        if (!sendAll(fd, &response, sizeof(response))) break;
+    }
+    close(fd);
+}
+
+void AnalysisCoordinator::runWorker(std::string_view coordinatorAddress) {
+    serveWorker(openSocket(coordinatorAddress, false));
+}
+
+std::uint64_t AnalysisCoordinator::answer(GameController& controller, Perft& perft, const Request& request) {
+    controller.restorePosition(request.position);
+    switch (request.kind) {
+        case WorkUnit::Kind::PERFT:
+            return perft.run(controller, request.depth, 1).nodes;
+        case WorkUnit::Kind::CLASSIFY:
+            return static_cast<std::uint64_t>(controller.calcGameState());
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+#include "GameController.h"
+#include "Perft.h"
+
+/* Spreads analysis jobs too big for one process over worker processes. A job is split into position-level work units;
+ each unit is sent to a worker over a socket and answered with one number.
+
+ Workers are forked from the coordinator (spawnWorkers(), over socket pairs) or are processes on other boxes that
+ connect to an address the coordinator listens on (listen() and runWorker()). Workers may join part-way through a job.
+ Each worker has at most Settings::unitsPerWorker units in flight, so faster workers simply come back for more. Once
+ nothing is left to hand out, units that have taken much longer than usual are also given to an idle worker, and
+ whichever answer arrives first is used. A worker whose connection drops has its units handed out again.
+
+ Results are kept by unit rather than by arrival, and every unit's answer depends on its position alone, so a job's
+ result is the same however the units were shared out.
+
+ Wire format: fixed-size frames in host byte order (so every box must share one architecture). Workers trust the
+ coordinator; its positions aren't validated.
+*/
+class AnalysisCoordinator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// STRUCTS
+    struct WorkUnit {
+        enum class Kind : std::uint8_t {
+            PERFT,    // answer: leaf count `depth` plies below the position (see Perft)
+            CLASSIFY, // answer: the position's Game::GameState
+        };
+        Game::PackedPosition position;
+        Kind kind {Kind::PERFT};
+        std::uint8_t depth {0};
+    };
+
+    struct Settings {
+        unsigned unitsPerWorker {2};                      // in flight at once, so a worker never waits on the coordinator
+        unsigned straggleFactor {4};                      // a unit straggles after this many times the mean unit time...
+        Clock::duration minStraggleTime {std::chrono::milliseconds{200}}; // ...and at least this long
+    };
+
+private:
+    // Frames. A run's id tells its answers apart from late ones to an earlier run
+    struct Request {
+        std::uint32_t runId;
+        std::uint32_t unitIndex;
+        WorkUnit::Kind kind;
+        std::uint8_t depth;
+        std::array<std::uint8_t, 6> reserved {};
+        Game::PackedPosition position;
+    };
+    static_assert(sizeof(Request) == 48);
+    struct Response {
+        std::uint32_t runId;
+        std::uint32_t unitIndex;
+        std::uint64_t answer;
+    };
+    static_assert(sizeof(Response) == 16);
+
+    struct Worker {
+        struct Assignment {
+            std::uint32_t runId;
+            std::uint32_t unitIndex;
+            Clock::time_point sentAt;
+        };
+        int fd;
+        pid_t pid {-1};                        // -1 if it connected rather than being spawned
+        std::string inbound {};                // a partly read Response
+        std::deque<Assignment> assignments {}; // oldest first, including ones from earlier runs it hasn't answered yet
+        bool isLost {false};
+    };
+
+    struct Run {
+        std::uint32_t id;
+        std::span<const WorkUnit> units;
+        std::vector<std::uint64_t> answers;
+        std::vector<bool> isAnswered;
+        std::vector<std::uint8_t> copiesInFlight;
+        std::deque<std::uint32_t> unassigned {};
+        std::size_t answeredCount {0};
+        Clock::duration totalUnitTime {0};
+    };
+
+    /// DATA MEMBERS
+    Settings settings;
+    std::vector<Worker> workers;
+    int listeningFd {-1};
+    std::uint32_t runCount {0};
+
+public:
+    /// CONSTRUCTORS
+    AnalysisCoordinator() = default;
+    explicit AnalysisCoordinator(const Settings& settings) : settings{settings} { }
+    AnalysisCoordinator(const AnalysisCoordinator&) = delete;
+    AnalysisCoordinator& operator=(const AnalysisCoordinator&) = delete;
+    ~AnalysisCoordinator(); // closes every connection and kills spawned workers
+
+    /// WORKERS
+    // Forks `count` workers. Call before starting any other threads: the children only ever run the worker loop
+    void spawnWorkers(unsigned count);
+    // "<port>" (127.0.0.1), "<IPv4 address>:<port>" or a Unix socket path. Throws std::runtime_error
+    void listen(std::string_view address);
+    [[nodiscard]] std::size_t countWorkers() const noexcept { return workers.size(); }
+
+    /// JOBS
+    // Answers in unit order. Throws std::runtime_error if every worker is lost (and none can connect) before the end
+    [[nodiscard]] std::vector<std::uint64_t> run(std::span<const WorkUnit> units);
+    // Same counts as Perft::run(). Shallow searches aren't worth shipping and are counted here
+    [[nodiscard]] Perft::Result perft(const GameController& controller, int depth);
+    [[nodiscard]] std::vector<Game::GameState> classify(std::span<const Game::PackedPosition> positions);
+
+    /// WORKER SIDE
+    // Answers requests on `fd` until the coordinator hangs up
+    static void serveWorker(int fd);
+    // Connects to a coordinator's listen() address, then serveWorker(). Throws std::runtime_error
+    static void runWorker(std::string_view coordinatorAddress);
+
+private:
+    void dispatch(Run& run);
+    bool assign(Worker& worker, Run& run, std::uint32_t unitIndex) noexcept; // false if the worker is lost
+    [[nodiscard]] Clock::duration calcStraggleTime(const Run& run) const noexcept;
+    void receive(Worker& worker, Run& run);
+    void dropLostWorkers(Run& run) noexcept;
+    void acceptWorker() noexcept;
+    static void closeWorker(const Worker& worker) noexcept;
+    [[nodiscard]] static std::uint64_t answer(GameController& controller, Perft& perft, const Request& request);
+};
@@ -0,0 +1,173 @@
+#include "BatchValidator.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <numeric>
+#include <type_traits>
+
+// Squares strictly between each (source, destination) pair, walked the way Board::isPathBlocked() walks them
+static const std::array<std::uint64_t, 64 * 64>& getBetweenMasks() noexcept {
+    static const std::array<std::uint64_t, 64 * 64> masks = [] {
+        std::array<std::uint64_t, 64 * 64> result {};
+        for (int source = 0; source < 64; ++source) {
+            for (int destination = 0; destination < 64; ++destination) {
+                const int rowDifference = destination / 8 - source / 8;
+                const int columnDifference = destination % 8 - source % 8;
+                if (rowDifference == 0 && columnDifference == 0) continue;
+                const int gcd = std::gcd(std::abs(rowDifference), std::abs(columnDifference));
+                const int step = (rowDifference / gcd) * 8 + columnDifference / gcd;
+                for (int square = source + step; square != destination; square += step) {
+                    result[source * 64 + destination] |= std::uint64_t{1} << square;
+                }
+            }
+        }
+        return result;
+    }();
+    return masks;
+}
+
+/// SUBMISSIONS
+
+void BatchValidator::add(const Game::PackedPosition& position, const Move& move) {
+    auto pieceAt = [&position](std::size_t square) -> std::uint8_t {
+        if ((position.occupancy >> square & 1) == 0) return 0;
+        const int slot = std::popcount(position.occupancy & ((std::uint64_t{1} << square) - 1));
+        return (position.pieces[slot / 2] >> (4 * (slot % 2))) & 0xF;
+    };
+    const auto source = static_cast<std::uint8_t>(move.getSourceIndex());
+    const auto destination = static_cast<std::uint8_t>(move.getDestinationIndex());
+    const auto promotionType = move.getPromotionType();
+
+    sources.push_back(source);
+    destinations.push_back(destination);
+    moverPieces.push_back(pieceAt(source));
+    destinationPieces.push_back(pieceAt(destination));
+    blackToMove.push_back(position.flags & 1);
+    enPassantSquares.push_back(position.enPassantSquare);
+    promotions.push_back(promotionType.has_value() ? static_cast<std::uint8_t>(*promotionType) + 1 : 0);
+    occupancies.push_back(position.occupancy);
+    positions.push_back(position);
+    moves.push_back(move);
+}
+
+void BatchValidator::clear() noexcept {
+    sources.clear();
+    destinations.clear();
+    moverPieces.clear();
+    destinationPieces.clear();
+    blackToMove.clear();
+    enPassantSquares.clear();
+    promotions.clear();
+    occupancies.clear();
+    blockedPaths.clear();
+    positions.clear();
+    moves.clear();
+    results.clear();
+}
+
+/// VALIDATION
+
+std::span<const Game::MoveValidity> BatchValidator::validate() noexcept {
+    results.resize(size());
+    runCheapChecks();
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (results[i] == Game::MoveValidity::VALID) {
+            results[i] = runFullCheck(i);
+        }
+    }
+    return results;
+}
+
+void BatchValidator::runCheapChecks() noexcept {
+    /// Every condition is worked out for every submission and the first failure picked with selects, as
+    /// calcMoveValidity() would find it, so the loops have no data-dependent branches
+    using enum Game::MoveValidity;
+    static_assert(std::is_same_v<std::underlying_type_t<Game::MoveValidity>, std::uint8_t>);
+    constexpr auto codeOf = [](Game::MoveValidity validity) { return static_cast<int>(validity); };
+    const std::size_t count = size();
+    blockedPaths.resize(count);
+
+    // the between-mask lookup is a gather from a 32 KiB table, so it gets a scalar pass of its own rather than stopping
+    // the main loop vectorising
+    const std::uint64_t* __restrict betweenMasks = getBetweenMasks().data();
+    const std::uint8_t* __restrict sourceColumn = sources.data();
+    const std::uint8_t* __restrict destinationColumn = destinations.data();
+    const std::uint64_t* __restrict occupancyColumn = occupancies.data();
+    std::uint8_t* __restrict blockedColumn = blockedPaths.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        blockedColumn[i] = (betweenMasks[sourceColumn[i] * 64 + destinationColumn[i]] & occupancyColumn[i]) != 0;
+    }
+
+    const std::uint8_t* __restrict moverColumn = moverPieces.data();
+    const std::uint8_t* __restrict capturedColumn = destinationPieces.data();
+    const std::uint8_t* __restrict blackToMoveColumn = blackToMove.data();
+    const std::uint8_t* __restrict enPassantColumn = enPassantSquares.data();
+    const std::uint8_t* __restrict promotionColumn = promotions.data();
+    auto* __restrict resultColumn = reinterpret_cast<std::uint8_t*>(results.data()); // MoveValidity codes
+    for (std::size_t i = 0; i < count; ++i) {
+        const int source = sourceColumn[i];
+        const int destination = destinationColumn[i];
+        const int mover = moverColumn[i];
+        const int captured = capturedColumn[i];
+        const int moverType = mover & 7; // Piece::Type + 1
+        const int moverIsBlack = mover >> 3;
+        const bool isCapture = (captured != 0);
+
+        const int rowDifference = (destination >> 3) - (source >> 3);
+        const int columnDifference = (destination & 7) - (source & 7);
+        const int rowDistance = std::abs(rowDifference);
+        const int columnDistance = std::abs(columnDifference);
+
+        // shapes. Conditions are combined with & and | rather than && and ||, which would be branches
+        const bool isStraight = (rowDifference == 0) != (columnDifference == 0);
+        const bool isDiagonal = (rowDistance == columnDistance);
+        const bool isKnightJump = (rowDistance * columnDistance == 2);
+        const bool isKingStep = (std::max(rowDistance, columnDistance) == 1);
+        const bool isCastlingPath = (rowDifference == 0) & (columnDistance == 2) & ((source == 4) | (source == 60));
+
+        // pawns: the en passant target square is that of the pawn that may be taken
+        const int pawnAdvance = (moverIsBlack != 0 ? -rowDifference : rowDifference);
+        const int pawnStartRow = (moverIsBlack != 0 ? 6 : 1);
+        const bool isPawnPush = (columnDifference == 0) & !isCapture
+                & ((pawnAdvance == 1) | ((pawnAdvance == 2) & ((source >> 3) == pawnStartRow)));
+        const bool isPawnCapture = (pawnAdvance == 1) & (columnDistance == 1)
+                & (isCapture | (enPassantColumn[i] == ((source & ~7) | (destination & 7))));
+
+        const bool isValidPath = ((moverType == 1) & (isPawnPush | isPawnCapture))
+                | ((moverType == 2) & isKnightJump)
+                | ((moverType == 3) & isDiagonal)
+                | ((moverType == 4) & isStraight)
+                | ((moverType == 5) & (isStraight | isDiagonal))
+                | ((moverType == 6) & (isKingStep | isCastlingPath));
+        const bool isBlocked = (blockedColumn[i] != 0);
+
+        // promotion: any type but PAWN and KING is accepted, as GameController::isValidPromotionType() does
+        const int promotion = promotionColumn[i];
+        const bool isPromotionMove = (moverType == 1) & ((destination >> 3) == (moverIsBlack != 0 ? 0 : 7));
+        const bool isValidPromotion = (promotion != 0) & (promotion != 1) & (promotion != 6);
+
+        // the first failure wins, so the selects go from the last check to the first. Castling availability (and
+        // anything after it) is left to the full check
+        int code = (promotion != 0 ? codeOf(UNEXPECTED_PROMOTION_PIECE) : codeOf(VALID));
+        code = (isPromotionMove ? (isValidPromotion ? codeOf(VALID) : codeOf(INVALID_PROMOTION_PIECE)) : code);
+        code = ((moverType == 6) & isCastlingPath ? codeOf(VALID) : code);
+        code = (isBlocked ? codeOf(PATH_BLOCKED) : code);
+        code = (!isValidPath ? codeOf(INVALID_MOVE_PATH) : code);
+        code = (isCapture & ((captured >> 3) == moverIsBlack) ? codeOf(CAPTURING_OWN_PIECE) : code);
+        code = (moverIsBlack != blackToMoveColumn[i] ? codeOf(MOVING_WRONG_COLOUR) : code);
+        code = (mover == 0 ? codeOf(NO_PIECE_AT_SOURCE) : code);
+        resultColumn[i] = static_cast<std::uint8_t>(code);
+    }
+}
+
+Game::MoveValidity BatchValidator::runFullCheck(std::size_t i) noexcept {
+    const Move& move = moves[i];
+    scratch.restorePosition(positions[i]);
+    if (King::isValidCastlingPath(move.getSource(), move.getDestination())) {
+        const Game::MoveValidity validity = scratch.calcMoveValidity(move);
+        if (validity != Game::MoveValidity::VALID) return validity;
+    }
+    return (scratch.leavesMoverInCheck(move) ? Game::MoveValidity::LEAVES_MOVER_IN_CHECK : Game::MoveValidity::VALID);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "GameController.h"
+
+/* Validates a tick's worth of move submissions from many games in one go, with the same answers submitMove() gives.
+
+ Submissions are laid out column by column (source squares together, destination squares together, ...), and the
+ cheap checks - a piece to move, whose it is, the move's shape for that piece, what's on the way - run as branch-free
+ loops over those columns. All but the path-blocking lookup (a scalar pass over a table) is one loop that GCC
+ vectorises at -O3. Only moves that get through them are made into a position to see whether they leave the mover's
+ king in check (and, for castling, whether castling is still available).
+
+ Reuse one BatchValidator from tick to tick so its columns keep their capacity.
+*/
+class BatchValidator {
+
+    /// DATA MEMBERS
+    // one entry per submission, in the order they were added
+    std::vector<std::uint8_t> sources;
+    std::vector<std::uint8_t> destinations;
+    std::vector<std::uint8_t> moverPieces;       // PackedPosition nibbles: (Piece::Type + 1) | (8 if black), 0 = empty
+    std::vector<std::uint8_t> destinationPieces;
+    std::vector<std::uint8_t> blackToMove;       // 0 or 1
+    std::vector<std::uint8_t> enPassantSquares;  // PackedPosition::noSquare if none
+    std::vector<std::uint8_t> promotions;        // Move promotion bits (Piece::Type + 1, 0 = none)
+    std::vector<std::uint64_t> occupancies;
+    std::vector<std::uint8_t> blockedPaths;      // 0 or 1, filled in by runCheapChecks()
+    std::vector<Game::MoveValidity> results;
+
+    std::vector<Game::PackedPosition> positions; // as submitted, for the moves that need the full check
+    std::vector<Move> moves;
+
+    GameController scratch; // the full check is done in here
+
+public:
+    /// SUBMISSIONS
+    void add(const Game::PackedPosition& position, const Move& move);
+    void clear() noexcept;
+    [[nodiscard]] std::size_t size() const noexcept { return sources.size(); }
+
+    /// VALIDATION
+    // One result per submission, in order. Valid until the next add() or clear()
+    [[nodiscard]] std::span<const Game::MoveValidity> validate() noexcept;
+
+private:
+    void runCheapChecks() noexcept;
+    [[nodiscard]] Game::MoveValidity runFullCheck(std::size_t i) noexcept;
+};
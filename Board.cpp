@@ -1,6 +1,6 @@
 #include "Board.h"
 
-bool Board::isPathBlocked(const Location &source, const Location &destination) const noexcept {
+bool Board::isPathBlocked(const Location &source, const Location &destination, const Location &vacated) const noexcept {
 
     const auto totalRowColumnDifferences = Location::calculateRowColumnDifferences(source, destination);
     const auto minimalDistanceMoveForGivenDirection = calculateMinimalDistanceMove(totalRowColumnDifferences);
@@ -16,7 +16,7 @@ bool Board::isPathBlocked(const Location &source, const Location &destination) c
 
     Location current = toNextSquare(source);
     while (current != destination) {
-        if (thereExistsPieceAt(current)) {
+        if (current != vacated && thereExistsPieceAt(current)) {
             return true;
         }
         current = toNextSquare(current);
@@ -36,12 +36,62 @@ Piece* Board::pieceAt(const Location &location) const noexcept{
     return board.at(location).get();
 }
 
+Board::Mailbox Board::calcMailbox() const noexcept {
+    Mailbox mailbox {};
+    for (const auto& [location, piece] : board) {
+        mailbox[location.getSquareIndex()] = piece.get();
+    }
+    return mailbox;
+}
+
+Location Board::getKingLocation(Piece::Colour colour) const {
+    const gsl::index squareIndex = kingSquareIndices[colour == Piece::Colour::WHITE ? 0 : 1];
+    return (squareIndex >= 0 ? Location::fromSquareIndex(squareIndex) : Location{});
+}
+
 void Board::erase(const Location &location) noexcept {
-    board.erase(location);
+    [[maybe_unused]] const auto piece = extract(location);
+}
+
+std::unique_ptr<Piece> Board::extract(const Location &location) noexcept {
+    auto node = board.extract(location);
+    ++mutationCount;
+    if (node.empty()) return nullptr;
+    countOut(location, *node.mapped());
+    return std::move(node.mapped());
 }
 
 void Board::insert(const Location &location, std::unique_ptr<Piece> piece) noexcept {
-    board.insert({location,std::move(piece)});
+    const Piece& inserted = *piece;
+    if (board.insert({location,std::move(piece)}).second) {
+        countIn(location, inserted);
+    }
+    ++mutationCount;
+}
+
+void Board::clear() noexcept {
+    board.clear();
+    materialKey = 0;
+    pieceHash = 0;
+    kingSquareIndices = {-1, -1};
+    ++mutationCount;
+}
+
+void Board::countIn(const Location &location, const Piece &piece) noexcept {
+    materialKey += std::uint64_t{1} << materialKeyShift(piece.getColour(), piece.getType());
+    pieceHash ^= Zobrist::pieceSquareKey(piece.getColour(), piece.getType(), location.getSquareIndex());
+    if (piece.getType() == Piece::Type::KING) {
+        kingSquareIndices[piece.getColour() == Piece::Colour::WHITE ? 0 : 1] = location.getSquareIndex();
+    }
+}
+
+void Board::countOut(const Location &location, const Piece &piece) noexcept {
+    materialKey -= std::uint64_t{1} << materialKeyShift(piece.getColour(), piece.getType());
+    pieceHash ^= Zobrist::pieceSquareKey(piece.getColour(), piece.getType(), location.getSquareIndex());
+    auto& kingSquareIndex = kingSquareIndices[piece.getColour() == Piece::Colour::WHITE ? 0 : 1];
+    if (piece.getType() == Piece::Type::KING && kingSquareIndex == location.getSquareIndex()) {
+        kingSquareIndex = -1;
+    }
 }
 
 Location::RowColumnDifferences Board::calculateMinimalDistanceMove(const Location::RowColumnDifferences& totalRowColumnDifferences) noexcept {
@@ -2,13 +2,23 @@
 
 #include "Piece.h"
 #include "Location.h"
+#include "Zobrist.h"
+#include <array>
 #include <map>
 #include <numeric>
 
 class Board {
 
+public:
+    using Mailbox = std::array<const Piece*, Location::getSquareCount()>; // indexed by Location::getSquareIndex()
+
+private:
     /// DATA MEMBERS
     std::map<Location, std::unique_ptr<Piece>> board;
+    std::uint64_t mutationCount {0}; // bumped by every change, so derived data can tell it's stale
+    std::uint64_t materialKey {0};   // piece count per colour and type, see getMaterialKey()
+    std::array<gsl::index, 2> kingSquareIndices {-1, -1}; // by colour, -1 if there's no king
+    std::uint64_t pieceHash {0};     // Zobrist hash of the pieces alone, see Game::calcHash()
 
     /// FRIENDS
     friend class GameController;
@@ -17,13 +27,7 @@ class Board {
 
     /// OPERATORS
 public:
-    // "function 'operator[]' with deduced return type cannot be used before it is defined"
-    auto& operator[](const Location& location) noexcept {
-        if (board.find(location) == board.end()) {
-            board[location] = nullptr;
-        }
-        return board[location];
-    }
+    // NB: No non-const version. Changes go through insert()/erase()/extract() so the counts below stay in step
     const auto& operator[](const Location& location) const {
         if (board.find(location) == board.end()) {
             throw std::runtime_error("Location not found in board");
@@ -38,18 +42,41 @@ public:
     [[nodiscard]] auto cbegin() const noexcept { return board.cbegin(); }
     [[nodiscard]] auto cend() const noexcept { return board.cend(); }
 
+    /// GETTERS
+
+    [[nodiscard]] std::uint64_t getMutationCount() const noexcept { return mutationCount; }
+
+    /* 4 bits per (colour, type) count, white pawns in the lowest nibble then up through the types, then black.
+     Equal keys mean equal material, so it can index endgame tables. */
+    [[nodiscard]] std::uint64_t getMaterialKey() const noexcept { return materialKey; }
+    [[nodiscard]] int getPieceCount(Piece::Colour colour, Piece::Type type) const noexcept {
+        return static_cast<int>((materialKey >> materialKeyShift(colour, type)) & 0xF);
+    }
+    [[nodiscard]] Location getKingLocation(Piece::Colour colour) const; // null Location if there's no king
+    [[nodiscard]] std::uint64_t getPieceHash() const noexcept { return pieceHash; }
+
     /// MISC.
 
-    [[nodiscard]] bool isPathBlocked(const Location &source, const Location &destination) const noexcept;
+    // `vacated` is treated as empty, eg. to ask about a king's destination with the king lifted off the board
+    [[nodiscard]] bool isPathBlocked(const Location &source, const Location &destination, const Location &vacated = Location{}) const noexcept;
 
     [[nodiscard]] bool thereExistsPieceAt(const Location &location) const noexcept;
     [[nodiscard]] Piece* pieceAt(const Location& location) const noexcept;
+    [[nodiscard]] Mailbox calcMailbox() const noexcept; // flat snapshot for code that probes many squares
 
     void erase(const Location& location) noexcept;
-    void insert(const Location& location, std::unique_ptr<Piece> piece) noexcept;
+    void insert(const Location& location, std::unique_ptr<Piece> piece) noexcept; // does nothing if `location` is taken
+    [[nodiscard]] std::unique_ptr<Piece> extract(const Location& location) noexcept; // erase() that hands back the piece
+    void clear() noexcept;
 
 private:
 
+    [[nodiscard]] static int materialKeyShift(Piece::Colour colour, Piece::Type type) noexcept {
+        return 4 * (static_cast<int>(type) + (colour == Piece::Colour::BLACK ? 6 : 0));
+    }
+    void countIn(const Location& location, const Piece& piece) noexcept;
+    void countOut(const Location& location, const Piece& piece) noexcept;
+
     static Location::RowColumnDifferences calculateMinimalDistanceMove(const Location::RowColumnDifferences& totalRowColumnDifferences) noexcept;
 
 };
@@ -0,0 +1,323 @@
+#include "BoardImage.h"
+#include "Checksum.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+/// SPRITES
+
+// 5x7 glyphs for the piece letters, one row per byte with the leftmost pixel in bit 4. Indexed by Piece::Type
+static constexpr std::array<std::array<std::uint8_t, 7>, 6> pieceGlyphs {{
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000}, // P
+    {0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001, 0b10001}, // N
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110}, // B
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001}, // R
+    {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101}, // Q
+    {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001}, // K
+}};
+
+SpriteAtlas::SpriteAtlas(int spriteSize) : spriteSize{spriteSize} {
+    if (spriteSize <= 0) {
+        throw std::invalid_argument("Sprite size must be positive");
+    }
+    pixels.resize(12 * static_cast<std::size_t>(spriteSize) * spriteSize * 4);
+}
+
+std::shared_ptr<const SpriteAtlas> SpriteAtlas::createDefault(int spriteSize) {
+    auto atlas = std::shared_ptr<SpriteAtlas>(new SpriteAtlas{spriteSize});
+
+    const double centre = (spriteSize - 1) / 2.0;
+    const double radius = 0.42 * spriteSize;
+    const double outlineWidth = std::max(1.0, spriteSize / 16.0);
+    const int glyphCellSize = std::max(1, spriteSize / 14); // letter is about half the sprite's height
+    const int glyphLeft = (spriteSize - 5 * glyphCellSize) / 2;
+    const int glyphTop = (spriteSize - 7 * glyphCellSize) / 2;
+
+    for (const auto colour : {Piece::Colour::WHITE, Piece::Colour::BLACK}) {
+        const bool isWhite = (colour == Piece::Colour::WHITE);
+        const std::array<std::uint8_t, 3> fill = isWhite ? std::array<std::uint8_t, 3>{245, 245, 245} : std::array<std::uint8_t, 3>{35, 35, 35};
+        const std::array<std::uint8_t, 3> ink = isWhite ? std::array<std::uint8_t, 3>{25, 25, 25} : std::array<std::uint8_t, 3>{230, 230, 230};
+
+        for (int type = 0; type < 6; ++type) {
+            auto* sprite = atlas->pixels.data() + spriteIndex(static_cast<Piece::Type>(type), colour) * spriteSize * spriteSize * 4;
+            const auto& glyph = pieceGlyphs[type];
+
+            for (int y = 0; y < spriteSize; ++y) {
+                for (int x = 0; x < spriteSize; ++x) {
+                    const double distance = std::hypot(x - centre, y - centre);
+                    const double coverage = std::clamp(radius - distance + 0.5, 0.0, 1.0); // 1px anti-aliased edge
+
+                    const int glyphColumn = (x - glyphLeft) / glyphCellSize;
+                    const int glyphRow = (y - glyphTop) / glyphCellSize;
+                    const bool isGlyph = x >= glyphLeft && y >= glyphTop && glyphColumn < 5 && glyphRow < 7
+                            && ((glyph[glyphRow] >> (4 - glyphColumn)) & 1) != 0;
+                    const bool isInk = isGlyph || distance > radius - outlineWidth;
+
+                    auto* pixel = sprite + (y * spriteSize + x) * 4;
+                    std::copy_n((isInk ? ink : fill).begin(), 3, pixel);
+                    pixel[3] = static_cast<std::uint8_t>(std::lround(coverage * 255));
+                }
+            }
+        }
+    }
+    return atlas;
+}
+
+std::shared_ptr<const SpriteAtlas> SpriteAtlas::fromImage(const RgbaImage& image) {
+    const int spriteSize = image.width / 6;
+    if (spriteSize == 0 || image.width != 6 * spriteSize || image.height != 2 * spriteSize
+            || image.pixels.size() != static_cast<std::size_t>(image.width) * image.height * 4) {
+        throw std::invalid_argument("Atlas image must be 6 x 2 square sprites");
+    }
+
+    auto atlas = std::shared_ptr<SpriteAtlas>(new SpriteAtlas{spriteSize});
+    for (int type = 0; type < 6; ++type) {
+        for (const auto colour : {Piece::Colour::WHITE, Piece::Colour::BLACK}) {
+            auto* sprite = atlas->pixels.data() + spriteIndex(static_cast<Piece::Type>(type), colour) * spriteSize * spriteSize * 4;
+            const int top = (colour == Piece::Colour::WHITE ? 0 : spriteSize);
+            for (int y = 0; y < spriteSize; ++y) {
+                const auto* row = image.pixels.data() + ((top + y) * image.width + type * spriteSize) * 4;
+                std::copy_n(row, spriteSize * 4, sprite + y * spriteSize * 4);
+            }
+        }
+    }
+    return atlas;
+}
+
+/// RENDERING
+
+static std::uint8_t blend(std::uint8_t source, std::uint8_t destination, int alpha) noexcept {
+    return static_cast<std::uint8_t>((source * alpha + destination * (255 - alpha) + 127) / 255);
+}
+
+RgbaImage BoardRenderer::render(const Board& board, const Highlights& highlights) const {
+    RgbaImage image;
+    renderInto(board, highlights, image);
+    return image;
+}
+
+void BoardRenderer::renderInto(const Board& board, const Highlights& highlights, RgbaImage& image) const {
+    using Colour = std::array<std::uint8_t, 3>;
+    static constexpr Colour lightSquare {240, 217, 181};
+    static constexpr Colour darkSquare {181, 136, 99};
+    static constexpr Colour lastMoveTint {246, 246, 105};
+    static constexpr Colour checkTint {235, 64, 52};
+
+    const int squareSize = atlas->getSpriteSize();
+    const gsl::index rowLength = Location::getMaxColumnIndex() + 1;
+    image.width = static_cast<int>(rowLength) * squareSize;
+    image.height = static_cast<int>(Location::getMaxRowIndex() + 1) * squareSize;
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+
+    const Board::Mailbox mailbox = board.calcMailbox();
+    std::uint64_t lastMoveSquares = 0;
+    if (highlights.lastMove.has_value()) {
+        lastMoveSquares = (std::uint64_t{1} << highlights.lastMove->getSourceIndex()) | (std::uint64_t{1} << highlights.lastMove->getDestinationIndex());
+    }
+    const std::uint64_t checkSquares = highlights.checkedKing.has_value() ? highlights.checkedKing->getSquareBit() : 0;
+
+    for (gsl::index squareIndex = 0; squareIndex < Location::getSquareCount(); ++squareIndex) {
+        const gsl::index row = squareIndex / rowLength;
+        const gsl::index column = squareIndex % rowLength;
+
+        Colour background = ((row + column) % 2 == 0 ? darkSquare : lightSquare); // A1 is dark
+        for (const auto& [squares, tint, alpha] : {std::tuple{lastMoveSquares, lastMoveTint, 128}, std::tuple{checkSquares, checkTint, 160}}) {
+            if (((squares >> squareIndex) & 1) == 0) continue;
+            for (int channel = 0; channel < 3; ++channel) {
+                background[channel] = blend(tint[channel], background[channel], alpha);
+            }
+        }
+
+        const Piece* piece = mailbox[squareIndex];
+        const std::uint8_t* sprite = (piece != nullptr ? atlas->getSprite(piece->getType(), piece->getColour()) : nullptr);
+        const int left = static_cast<int>(column) * squareSize;
+        const int top = static_cast<int>(Location::getMaxRowIndex() - row) * squareSize; // white at the bottom
+
+        for (int y = 0; y < squareSize; ++y) {
+            std::uint8_t* pixel = image.pixels.data() + (static_cast<std::size_t>(top + y) * image.width + left) * 4;
+            for (int x = 0; x < squareSize; ++x, pixel += 4) {
+                if (sprite == nullptr) {
+                    std::copy(background.begin(), background.end(), pixel);
+                } else {
+                    const std::uint8_t* spritePixel = sprite + (y * squareSize + x) * 4;
+                    for (int channel = 0; channel < 3; ++channel) {
+                        pixel[channel] = blend(spritePixel[channel], background[channel], spritePixel[3]);
+                    }
+                }
+                pixel[3] = 255;
+            }
+        }
+    }
+}
+
+std::vector<std::vector<std::uint8_t>> BoardRenderer::renderPngs(std::span<const Request> requests, unsigned threadCount) const {
+    std::vector<std::vector<std::uint8_t>> pngs(requests.size());
+    std::atomic<std::size_t> nextRequest {0};
+
+    auto work = [&]() {
+        RgbaImage image; // reused, so each thread allocates its pixel buffer once
+        for (std::size_t i = nextRequest++; i < requests.size(); i = nextRequest++) {
+            renderInto(*requests[i].board, requests[i].highlights, image);
+            pngs[i] = encodePng(image);
+        }
+    };
+
+    threadCount = std::clamp<unsigned>(threadCount, 1, static_cast<unsigned>(std::max<std::size_t>(requests.size(), 1)));
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            threads.emplace_back(work);
+        }
+        work();
+    }
+    return pngs;
+}
+
+/// PNG
+
+static std::uint32_t adler32(const std::vector<std::uint8_t>& data) noexcept {
+    constexpr std::uint32_t modulus = 65521;
+    constexpr std::size_t maxBlock = 5552; // longest run before the sums could overflow 32 bits
+    std::uint32_t a = 1, b = 0;
+    for (std::size_t start = 0; start < data.size(); start += maxBlock) {
+        const std::size_t end = std::min(data.size(), start + maxBlock);
+        for (std::size_t i = start; i < end; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= modulus;
+        b %= modulus;
+    }
+    return (b << 16) | a;
+}
+
+/// Deflate bit stream (RFC 1951): bits are packed from the least significant end, Huffman codes most significant bit first
+class DeflateWriter {
+    std::vector<std::uint8_t>& output;
+    std::uint64_t bitBuffer {0};
+    int bitCount {0};
+
+public:
+    explicit DeflateWriter(std::vector<std::uint8_t>& output) : output{output} { }
+
+    void writeBits(std::uint32_t value, int count) {
+        bitBuffer |= static_cast<std::uint64_t>(value) << bitCount;
+        bitCount += count;
+        while (bitCount >= 8) {
+            output.push_back(static_cast<std::uint8_t>(bitBuffer));
+            bitBuffer >>= 8;
+            bitCount -= 8;
+        }
+    }
+
+    void writeCode(std::uint32_t code, int length) {
+        std::uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        }
+        writeBits(reversed, length);
+    }
+
+    // Fixed Huffman literal/length alphabet
+    void writeSymbol(int symbol) {
+        if (symbol < 144) writeCode(0x30 + symbol, 8);
+        else if (symbol < 256) writeCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280) writeCode(symbol - 256, 7);
+        else writeCode(0xC0 + symbol - 280, 8);
+    }
+
+    void writeMatch(int length, int distance) {
+        static constexpr std::array<int, 29> lengthBases {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr std::array<int, 29> lengthExtraBits {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static constexpr std::array<int, 30> distanceBases {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static constexpr std::array<int, 30> distanceExtraBits {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        const auto lengthCode = std::upper_bound(lengthBases.begin(), lengthBases.end(), length) - lengthBases.begin() - 1;
+        writeSymbol(257 + static_cast<int>(lengthCode));
+        writeBits(length - lengthBases[lengthCode], lengthExtraBits[lengthCode]);
+
+        const auto distanceCode = std::upper_bound(distanceBases.begin(), distanceBases.end(), distance) - distanceBases.begin() - 1;
+        writeCode(static_cast<std::uint32_t>(distanceCode), 5);
+        writeBits(distance - distanceBases[distanceCode], distanceExtraBits[distanceCode]);
+    }
+
+    void flush() {
+        if (bitCount > 0) writeBits(0, 8 - bitCount);
+    }
+};
+
+/* One fixed-Huffman block. Board images are flat squares, so rather than a general match finder it only tries the
+ two repeats that dominate them: the previous pixel and the same pixel on the previous row. */
+static void deflateImageRows(const std::vector<std::uint8_t>& data, std::size_t rowStride, std::vector<std::uint8_t>& output) {
+    constexpr int minMatch = 3, maxMatch = 258;
+    constexpr std::size_t maxDistance = 32768;
+
+    DeflateWriter writer {output};
+    writer.writeBits(1, 1); // final block
+    writer.writeBits(1, 2); // fixed Huffman codes
+
+    std::size_t i = 0;
+    while (i < data.size()) {
+        int bestLength = 0;
+        std::size_t bestDistance = 0;
+        for (const std::size_t distance : {std::size_t{4}, rowStride}) {
+            if (distance > i || distance > maxDistance) continue;
+            const std::size_t limit = std::min<std::size_t>(maxMatch, data.size() - i);
+            std::size_t length = 0;
+            while (length < limit && data[i + length] == data[i + length - distance]) ++length;
+            if (static_cast<int>(length) > bestLength) {
+                bestLength = static_cast<int>(length);
+                bestDistance = distance;
+            }
+        }
+
+        if (bestLength >= minMatch) {
+            writer.writeMatch(bestLength, static_cast<int>(bestDistance));
+            i += bestLength;
+        } else {
+            writer.writeSymbol(data[i]);
+            ++i;
+        }
+    }
+    writer.writeSymbol(256); // end of block
+    writer.flush();
+}
+
+std::vector<std::uint8_t> encodePng(const RgbaImage& image) {
+    auto appendUint32 = [](std::vector<std::uint8_t>& out, std::uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<std::uint8_t>(value >> shift));
+    };
+    std::vector<std::uint8_t> png {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    auto appendChunk = [&](const char (&type)[5], const std::vector<std::uint8_t>& data) {
+        appendUint32(png, static_cast<std::uint32_t>(data.size()));
+        const std::size_t typeStart = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        appendUint32(png, crc32(png.data() + typeStart, png.size() - typeStart));
+    };
+
+    std::vector<std::uint8_t> header;
+    appendUint32(header, static_cast<std::uint32_t>(image.width));
+    appendUint32(header, static_cast<std::uint32_t>(image.height));
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlace
+    appendChunk("IHDR", header);
+
+    // scanlines, each prefixed with filter type 0 (none)
+    const std::size_t rowBytes = static_cast<std::size_t>(image.width) * 4;
+    std::vector<std::uint8_t> scanlines;
+    scanlines.reserve((rowBytes + 1) * image.height);
+    for (int y = 0; y < image.height; ++y) {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), image.pixels.begin() + y * rowBytes, image.pixels.begin() + (y + 1) * rowBytes);
+    }
+
+    std::vector<std::uint8_t> compressed {0x78, 0x01}; // zlib header: deflate, 32K window, no dictionary
+    deflateImageRows(scanlines, rowBytes + 1, compressed);
+    appendUint32(compressed, adler32(scanlines));
+    appendChunk("IDAT", compressed);
+
+    appendChunk("IEND", {});
+    return png;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "Board.h"
+#include "Move.h"
+
+/* Software rendering of a Board to pixels, for board images where there's no GPU or window (eg. thumbnails on a
+ server). Everything here is const after construction, so one renderer can be shared by any number of threads.
+*/
+
+struct RgbaImage {
+    int width {0};
+    int height {0};
+    std::vector<std::uint8_t> pixels; // row-major, 4 bytes per pixel, not premultiplied
+};
+
+/// One square-sized RGBA sprite per piece
+class SpriteAtlas {
+    /// DATA MEMBERS
+    int spriteSize;
+    std::vector<std::uint8_t> pixels; // sprites back to back, indexed by spriteIndex()
+
+    /// CONSTRUCTORS
+    explicit SpriteAtlas(int spriteSize);
+
+public:
+    // Plain discs with the piece's letter on them, drawn in code so no asset files are needed
+    [[nodiscard]] static std::shared_ptr<const SpriteAtlas> createDefault(int spriteSize);
+
+    /* From a decoded atlas image laid out as 6 columns x 2 rows of square sprites: pawn, knight, bishop, rook, queen,
+     king from left to right, white on the top row and black below. Throws std::invalid_argument for any other shape. */
+    [[nodiscard]] static std::shared_ptr<const SpriteAtlas> fromImage(const RgbaImage& image);
+
+    /// GETTERS
+    [[nodiscard]] int getSpriteSize() const noexcept { return spriteSize; }
+    [[nodiscard]] const std::uint8_t* getSprite(Piece::Type type, Piece::Colour colour) const noexcept {
+        return pixels.data() + spriteIndex(type, colour) * spriteSize * spriteSize * 4;
+    }
+
+private:
+    [[nodiscard]] static std::size_t spriteIndex(Piece::Type type, Piece::Colour colour) noexcept {
+        return static_cast<std::size_t>(type) + (colour == Piece::Colour::BLACK ? 6 : 0);
+    }
+};
+
+class BoardRenderer {
+public:
+    /// STRUCTS
+    struct Highlights {
+        std::optional<Move> lastMove;
+        std::optional<Location> checkedKing;
+    };
+    struct Request {
+        const Board* board;
+        Highlights highlights;
+    };
+
+private:
+    /// DATA MEMBERS
+    std::shared_ptr<const SpriteAtlas> atlas;
+
+public:
+    /// CONSTRUCTORS
+    explicit BoardRenderer(std::shared_ptr<const SpriteAtlas> atlas) : atlas{std::move(atlas)} { }
+
+    /// RENDERING
+    // White at the bottom. Images are 8 sprites square
+    [[nodiscard]] RgbaImage render(const Board& board, const Highlights& highlights = {}) const;
+    void renderInto(const Board& board, const Highlights& highlights, RgbaImage& image) const; // reuses image's buffer
+
+    // render() + encodePng() for each request, split over `threadCount` threads. Results are in request order
+    [[nodiscard]] std::vector<std::vector<std::uint8_t>> renderPngs(std::span<const Request> requests, unsigned threadCount) const;
+};
+
+/// PNG bytes for `image` (8-bit RGBA, no interlacing)
+[[nodiscard]] std::vector<std::uint8_t> encodePng(const RgbaImage& image);
@@ -0,0 +1,59 @@
+#include "ChessClock.h"
+
+#include <algorithm>
+
+static std::size_t indexOf(Piece::Colour colour) noexcept {
+    return (colour == Piece::Colour::WHITE ? 0 : 1);
+}
+
+/// CONSTRUCTORS
+
+ChessClock::ChessClock(const TimeControl& timeControl, Piece::Colour toMove, Clock::time_point now)
+        : timeControl{timeControl}, remaining{timeControl.base, timeControl.base}, turnStart{now}, running{toMove} {
+    if (timeControl.base <= Clock::duration::zero() || timeControl.increment < Clock::duration::zero() || timeControl.delay < Clock::duration::zero()) {
+        throw std::invalid_argument("Time control needs a positive base time and no negative increment or delay");
+    }
+}
+
+/// TIMING
+
+void ChessClock::switchSides(Clock::time_point now) {
+    remaining[indexOf(running)] = calcRemaining(running, now) + timeControl.increment;
+    running = (running == Piece::Colour::WHITE ? Piece::Colour::BLACK : Piece::Colour::WHITE);
+    turnStart = now;
+    armTimer();
+}
+
+void ChessClock::attachTimer(TimerWheel& timerWheel, std::uint64_t tag) {
+    stop();
+    wheel = &timerWheel;
+    timerTag = tag;
+    armTimer();
+}
+
+void ChessClock::stop() noexcept {
+    if (wheel != nullptr) {
+        wheel->cancel(timer);
+    }
+    wheel = nullptr;
+    timer = 0;
+}
+
+void ChessClock::armTimer() {
+    if (wheel == nullptr) return;
+    wheel->cancel(timer); // O(1), and a no-op for a timer that has already fired
+    timer = wheel->arm(calcFlagFallTime(), timerTag);
+}
+
+/// GETTERS
+
+ChessClock::Clock::duration ChessClock::calcRemaining(Piece::Colour colour, Clock::time_point now) const noexcept {
+    const Clock::duration left = remaining[indexOf(colour)];
+    if (colour != running) return left;
+    const Clock::duration charged = std::max(now - turnStart - timeControl.delay, Clock::duration::zero());
+    return std::max(left - charged, Clock::duration::zero());
+}
+
+ChessClock::Clock::time_point ChessClock::calcFlagFallTime() const noexcept {
+    return turnStart + timeControl.delay + remaining[indexOf(running)];
+}
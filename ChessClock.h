@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include "Piece.h"
+#include "TimerWheel.h"
+
+/// Base time each, Fischer increment added after each move, and delay: time at the start of each turn that isn't
+/// charged (US/simple delay)
+struct TimeControl {
+    std::chrono::milliseconds base {0};
+    std::chrono::milliseconds increment {0};
+    std::chrono::milliseconds delay {0};
+};
+
+/* Both players' time in one game. Only the side to move's clock runs.
+
+ With a TimerWheel attached, a timer is kept armed for the moment the running side's flag falls, and re-armed when
+ the clock is switched, so flag fall is found by the wheel's owner without looking at the clocks. The clock doesn't
+ own its timer: copies share it, and only the copy that is switched or stopped should be kept.
+*/
+class ChessClock {
+public:
+    using Clock = TimerWheel::Clock;
+
+private:
+    /// DATA MEMBERS
+    TimeControl timeControl;
+    std::array<Clock::duration, 2> remaining; // by Piece::Colour, as of the start of the current turn
+    Clock::time_point turnStart;
+    Piece::Colour running;
+    TimerWheel* wheel {nullptr};
+    TimerWheel::TimerId timer {0};
+    std::uint64_t timerTag {0};
+
+public:
+    /// CONSTRUCTORS
+    ChessClock(const TimeControl& timeControl, Piece::Colour toMove, Clock::time_point now);
+
+    /// TIMING
+    // Charges the running side for its turn, adds the increment and starts the other side's clock
+    void switchSides(Clock::time_point now);
+    void attachTimer(TimerWheel& timerWheel, std::uint64_t tag); // `tag` is what the wheel hands back at flag fall
+    void stop() noexcept; // cancels and detaches the timer, if any; the clock may still be read
+
+    /// GETTERS
+    [[nodiscard]] Clock::duration calcRemaining(Piece::Colour colour, Clock::time_point now) const noexcept;
+    [[nodiscard]] Clock::time_point calcFlagFallTime() const noexcept; // of the running side
+    [[nodiscard]] bool hasFlagFallen(Clock::time_point now) const noexcept { return now >= calcFlagFallTime(); }
+    [[nodiscard]] Piece::Colour getRunning() const noexcept { return running; }
+    [[nodiscard]] const TimeControl& getTimeControl() const noexcept { return timeControl; }
+
+private:
+    void armTimer();
+};
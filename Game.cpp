@@ -4,26 +4,131 @@
 
 #include "Game.h"
 
+#include <bit>
+
 Game::Game(const Game &other)
         : gameState{other.gameState}
         , enPassantTargetSquare{other.enPassantTargetSquare}
         , whiteCastlingAvailability{other.whiteCastlingAvailability}
         , blackCastlingAvailability{other.blackCastlingAvailability}
         , activePlayer{other.activePlayer}
+        , network{other.network}
+        , accumulator{other.accumulator}
+        , history{other.history}
+        , plyCount{other.plyCount}
+        , checkpoints{other.checkpoints}
+        , clock{other.clock}
 {
     for (const auto& pair : other.board) {
-        board[pair.first] = pair.second->clone();
+        board.insert(pair.first, pair.second->clone());
     }
 }
 
 Game &Game::operator=(const Game &other) {
     if (this != &other) {
+        // NB: not copy-and-swap; std::swap(*this, temp) would call this operator again. The players are const and
+        // identical in every Game, so everything else is copied across.
         Game temp(other);
-        std::swap(*this, temp);
+        board = std::move(temp.board);
+        gameState = other.gameState;
+        enPassantTargetSquare = other.enPassantTargetSquare;
+        whiteCastlingAvailability = other.whiteCastlingAvailability;
+        blackCastlingAvailability = other.blackCastlingAvailability;
+        activePlayer = other.activePlayer;
+        network = other.network;
+        accumulator = other.accumulator;
+        history = other.history;
+        plyCount = other.plyCount;
+        checkpoints = other.checkpoints;
+        clock = other.clock;
+        legalMoveCache.reset(); // keyed on the mutation count of a board that's just been replaced
     }
     return *this;
 }
 
+void Game::attachNetwork(std::shared_ptr<const NnueNetwork> newNetwork) noexcept {
+    network = std::move(newNetwork);
+    refreshAccumulator();
+}
+
+void Game::refreshAccumulator() noexcept {
+    if (network == nullptr) return;
+    network->refresh(board, Piece::Colour::WHITE, accumulator);
+    network->refresh(board, Piece::Colour::BLACK, accumulator);
+}
+
+std::uint64_t Game::calcHash() const noexcept {
+    std::uint64_t hash = board.getPieceHash();
+    if (activePlayer == blackPlayer) hash ^= Zobrist::blackToMoveKey();
+    if (whiteCastlingAvailability.kingSide) hash ^= Zobrist::castlingKey(0);
+    if (whiteCastlingAvailability.queenSide) hash ^= Zobrist::castlingKey(1);
+    if (blackCastlingAvailability.kingSide) hash ^= Zobrist::castlingKey(2);
+    if (blackCastlingAvailability.queenSide) hash ^= Zobrist::castlingKey(3);
+    if (enPassantTargetSquare != Location{}) hash ^= Zobrist::enPassantFileKey(enPassantTargetSquare.getBoardColumnIndex().value());
+    return hash;
+}
+
+Game::PackedPosition Game::takeSnapshot() const noexcept {
+    PackedPosition snapshot;
+    for (const auto& [location, piece] : board) {
+        Expects(piece != nullptr); // the board only holds squares with a piece on
+        snapshot.occupancy |= location.getSquareBit();
+    }
+    for (const auto& [location, piece] : board) {
+        // rank among the occupied squares, whatever order the board iterates in
+        const int slot = std::popcount(snapshot.occupancy & (location.getSquareBit() - 1));
+        if (slot >= 32) continue;
+        const auto nibble = static_cast<std::uint8_t>(
+                (static_cast<std::uint8_t>(piece->getType()) + 1) | (piece->getColour() == Piece::Colour::BLACK ? 8 : 0));
+        snapshot.pieces[slot / 2] |= static_cast<std::uint8_t>(nibble << (4 * (slot % 2)));
+    }
+
+    snapshot.flags = static_cast<std::uint8_t>(
+            (activePlayer == blackPlayer ? 1 : 0)
+            | (whiteCastlingAvailability.kingSide ? 1 << 1 : 0)
+            | (whiteCastlingAvailability.queenSide ? 1 << 2 : 0)
+            | (blackCastlingAvailability.kingSide ? 1 << 3 : 0)
+            | (blackCastlingAvailability.queenSide ? 1 << 4 : 0)
+            | (static_cast<int>(gameState) << 5));
+
+    if (enPassantTargetSquare != Location{}) {
+        snapshot.enPassantSquare = static_cast<std::uint8_t>(enPassantTargetSquare.getSquareIndex());
+    }
+    return snapshot;
+}
+
+void Game::restoreSnapshot(const PackedPosition& snapshot) noexcept {
+    restorePosition(snapshot);
+    history.clear();
+    plyCount = 0;
+    checkpoints.clear();
+}
+
+void Game::restorePosition(const PackedPosition& snapshot) noexcept {
+    board.clear(); // NB: not `board = Board{}`, which would restart the mutation count legalMoveCache is keyed on
+    int slot = 0;
+    for (std::uint64_t squares = snapshot.occupancy; squares != 0 && slot < 32; squares &= squares - 1, ++slot) {
+        const int nibble = (snapshot.pieces[slot / 2] >> (4 * (slot % 2))) & 0xF;
+        const auto type = static_cast<Piece::Type>((nibble & 7) - 1);
+        const auto colour = ((nibble & 8) != 0 ? Piece::Colour::BLACK : Piece::Colour::WHITE);
+        board.insert(Location::fromSquareIndex(std::countr_zero(squares)), Piece::create(type, colour));
+    }
+
+    activePlayer = ((snapshot.flags & 1) != 0 ? blackPlayer : whitePlayer);
+    whiteCastlingAvailability = {.kingSide = (snapshot.flags & (1 << 1)) != 0, .queenSide = (snapshot.flags & (1 << 2)) != 0};
+    blackCastlingAvailability = {.kingSide = (snapshot.flags & (1 << 3)) != 0, .queenSide = (snapshot.flags & (1 << 4)) != 0};
+    gameState = snapshot.getGameState();
+    enPassantTargetSquare = (snapshot.enPassantSquare == PackedPosition::noSquare ? Location{} : Location::fromSquareIndex(snapshot.enPassantSquare));
+    refreshAccumulator();
+}
+
+int Game::evaluate() const {
+    if (network == nullptr) {
+        throw std::runtime_error("No evaluation network attached");
+    }
+    return network->evaluate(accumulator, activePlayer.getColour());
+}
+
 std::string Game::gameStateAsString(Game::GameState gs) noexcept {
     switch (gs) {
         case GameState::WHITE_WIN: return "White Wins";
@@ -33,3 +138,20 @@ std::string Game::gameStateAsString(Game::GameState gs) noexcept {
         case GameState::IN_PROGRESS: return "Game In Progress";
     }
 }
+
+std::string_view Game::moveValidityAsString(Game::MoveValidity mv) noexcept {
+    switch (mv) {
+        case MoveValidity::VALID: return "Valid move";
+        case MoveValidity::NO_PIECE_AT_SOURCE: return "No piece at source square";
+        case MoveValidity::MOVING_WRONG_COLOUR: return "Moving wrong colour piece";
+        case MoveValidity::CAPTURING_OWN_PIECE: return "Can't take your own piece";
+        case MoveValidity::INVALID_MOVE_PATH: return "Piece can't move that way";
+        case MoveValidity::PATH_BLOCKED: return "Path blocked";
+        case MoveValidity::INVALID_CASTLING: return "Invalid castling attempt";
+        case MoveValidity::INVALID_PROMOTION_PIECE: return "Invalid promotion piece";
+        case MoveValidity::UNEXPECTED_PROMOTION_PIECE: return "Move includes promotion piece but can't promote";
+        case MoveValidity::LEAVES_MOVER_IN_CHECK: return "Move leaves mover in check";
+        case MoveValidity::OUT_OF_TIME: return "Out of time";
+    }
+    return "Unknown move validity";
+}
@@ -1,24 +1,69 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <string_view>
 #include "Board.h"
 #include "Player.h"
 #include "Piece.h"
+#include "Move.h"
+#include "NnueEvaluator.h"
+#include "ChessClock.h"
 
 class Game {
     /// STRUCTS / ENUM
 public:
     enum GameState {IN_PROGRESS, DRAW, STALEMATE, WHITE_WIN, BLACK_WIN};
+    enum class MoveValidity : std::uint8_t {
+        VALID,
+        NO_PIECE_AT_SOURCE,
+        MOVING_WRONG_COLOUR,
+        CAPTURING_OWN_PIECE,
+        INVALID_MOVE_PATH,
+        PATH_BLOCKED,
+        INVALID_CASTLING,
+        INVALID_PROMOTION_PIECE,
+        UNEXPECTED_PROMOTION_PIECE,
+        LEAVES_MOVER_IN_CHECK,
+        OUT_OF_TIME // the mover's flag fell before the move arrived
+    };
+    /* The whole position (bar the evaluator accumulator) in 32 bytes. Every position has exactly one encoding and there
+     are no padding bytes, so it can be compared, hashed and memcpy'd as plain bytes (eg. as a hash map key) */
+    struct PackedPosition {
+        std::uint64_t occupancy {0}; // bit i set = a piece on square i (see Location::getSquareIndex())
+        /* One nibble per occupied square in square order, low nibble first: (Piece::Type + 1) | (8 if black).
+           Unused nibbles are 0. NB: so at most 32 pieces, as in any legal position */
+        std::array<std::uint8_t, 16> pieces {};
+        /* bit  0   : black to move
+           bits 1-4 : castling availability (white king side, white queen side, black king side, black queen side)
+           bits 5-7 : GameState */
+        std::uint8_t flags {0};
+        std::uint8_t enPassantSquare {noSquare};
+        std::array<std::uint8_t, 6> reserved {}; // always 0
+
+        static constexpr std::uint8_t noSquare = 0xFF;
+
+        [[nodiscard]] GameState getGameState() const noexcept { return static_cast<GameState>(flags >> 5); }
+        bool operator==(const PackedPosition& other) const noexcept = default;
+    };
+    static_assert(sizeof(PackedPosition) == 32);
+    static_assert(std::has_unique_object_representations_v<PackedPosition>);
+
+    static constexpr std::size_t checkpointInterval = 16; // plies between the history's full-position checkpoints
 private:
+    // Legal moves for `colour` as of the board's `boardMutationCount`
+    struct LegalMoveCache {
+        MoveList moves;
+        std::uint64_t boardMutationCount;
+        Piece::Colour colour;
+    };
     struct castlingAvailability {
         bool kingSide = true;
         bool queenSide = true;
     };
-    struct MoveInfo {
-        const Location source;
-        const Location destination;
-        std::unique_ptr<Piece> promotionPiece;
-    };
     /// DATA MEMBERS
     Board board{};
     GameState gameState {IN_PROGRESS};
@@ -28,6 +73,13 @@ private:
     castlingAvailability whiteCastlingAvailability {.kingSide = true, .queenSide = true};
     castlingAvailability blackCastlingAvailability {.kingSide = true, .queenSide = true};
     Player activePlayer = whitePlayer;
+    std::shared_ptr<const NnueNetwork> network; // optional; shared by copies
+    NnueAccumulator accumulator;                // kept in sync by GameController::makeMove() while `network` is set
+    std::vector<Move> history;                  // every ply recorded, including undone ones that can still be redone
+    std::size_t plyCount {0};                   // plies on the board, ie. history[plyCount..] were undone
+    std::vector<PackedPosition> checkpoints;    // checkpoints[i] = position before ply i * checkpointInterval
+    std::optional<ChessClock> clock;            // none = untimed. Charged by GameController::submitMove()
+    mutable std::optional<LegalMoveCache> legalMoveCache; // see GameController::getLegalMoves(). Not copied
 
     /// FRIENDS
     friend class GameController;
@@ -38,7 +90,43 @@ public:
     Game(const Game& other);
     Game& operator=(const Game& other);
 
+    /// GETTERS
+    [[nodiscard]] const Board& getBoard() const noexcept { return board; }
+    [[nodiscard]] const Player& getActivePlayer() const noexcept { return activePlayer; }
+    [[nodiscard]] const Location& getEnPassantTargetSquare() const noexcept { return enPassantTargetSquare; }
+    [[nodiscard]] GameState getGameState() const noexcept { return gameState; }
+    [[nodiscard]] const std::vector<Move>& getHistory() const noexcept { return history; }
+    [[nodiscard]] std::size_t getPlyCount() const noexcept { return plyCount; }
+    [[nodiscard]] const std::optional<ChessClock>& getClock() const noexcept { return clock; }
+    [[nodiscard]] std::uint64_t calcHash() const noexcept; // Zobrist hash of the position; O(1), the board keeps its part up to date
+
+    /// SNAPSHOTS
+    [[nodiscard]] PackedPosition takeSnapshot() const noexcept; // O(pieces)
+    void restoreSnapshot(const PackedPosition& snapshot) noexcept; // NB: clears the move history, it belongs to the old position
+
+    /// EVALUATION
+    void attachNetwork(std::shared_ptr<const NnueNetwork> newNetwork) noexcept;
+    [[nodiscard]] int evaluate() const; // centipawns for the active player. Throws if no network is attached
+
     /// MISC.
     static std::string gameStateAsString(GameState gs) noexcept;
+    static std::string_view moveValidityAsString(MoveValidity mv) noexcept; // NB: only for views, validation itself never builds strings
+
+private:
+    void refreshAccumulator() noexcept; // after setting up a position outside of GameController::makeMove()
+    void restorePosition(const PackedPosition& snapshot) noexcept; // leaves the history alone
 };
 
+template <>
+struct std::hash<Game::PackedPosition> {
+    [[nodiscard]] std::size_t operator()(const Game::PackedPosition& position) const noexcept {
+        std::array<std::uint64_t, sizeof(position) / 8> words;
+        std::memcpy(words.data(), &position, sizeof(position));
+        std::uint64_t hash = 0;
+        for (std::uint64_t word : words) { // multiply-xorshift, so every input bit reaches the low bits used for buckets
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 32;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+};
@@ -1,4 +1,5 @@
 #include "GameController.h"
+#include "PositionFeed.h"
 
 void GameController::setup() noexcept {
     const auto& BLACK = Piece::Colour::BLACK;
@@ -25,6 +26,7 @@ void GameController::setup() noexcept {
         board.insert(Location{"D" + pieceRow}, std::make_unique<Queen>(colour));
         board.insert(Location{"E" + pieceRow}, std::make_unique<King>(colour));
     }
+    game.refreshAccumulator();
 }
 
 void GameController::setupSimple() noexcept {
@@ -37,15 +39,141 @@ void GameController::setupSimple() noexcept {
     board.insert(Location{"A3"}, std::make_unique<King>(WHITE));
     board.insert(Location{"D2"}, std::make_unique<Knight>(WHITE));
     board.insert(Location{"A1"}, std::make_unique<King>(BLACK));
+    game.refreshAccumulator();
 }
 
-void GameController::makeMove(const Location &source, const Location &destination, const Piece* promotionPiece = nullptr) noexcept {
+void GameController::setupFromFen(std::string_view fen) {
+    /// Fields: placement, side to move, castling, en passant target, then the (ignored) halfmove and fullmove counters
+    auto nextField = [&fen]() {
+        const std::size_t start = fen.find_first_not_of(' ');
+        if (start == std::string_view::npos) return std::string_view{};
+        fen.remove_prefix(start);
+        const std::string_view field = fen.substr(0, fen.find(' '));
+        fen.remove_prefix(field.size());
+        return field;
+    };
+    const std::string_view placement = nextField(), activeColour = nextField(), castling = nextField(), enPassant = nextField();
+    if (enPassant.empty()) {
+        throw std::invalid_argument("FEN needs at least placement, side to move, castling and en passant fields");
+    }
+
+    Game::PackedPosition position;
+    std::array<std::uint8_t, Location::getSquareCount()> nibbles {};
+    std::array<int, 2> kingCounts {}, pawnCounts {}, pieceCounts {}; // by colour, white first
+    int row = 7, column = 0;
+    for (const char c : placement) {
+        if (c == '/') {
+            if (column != 8 || row == 0) throw std::invalid_argument("FEN rank doesn't have 8 squares");
+            --row;
+            column = 0;
+        } else if (c >= '1' && c <= '8') {
+            column += c - '0';
+            if (column > 8) throw std::invalid_argument("FEN rank doesn't have 8 squares");
+        } else {
+            static constexpr std::string_view pieceChars = "pnbrqk"; // in Piece::Type order
+            const std::size_t type = pieceChars.find(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+            if (type == std::string_view::npos || column == 8) throw std::invalid_argument(std::format("Invalid FEN piece '{}'", c));
+            const bool isBlack = std::islower(static_cast<unsigned char>(c));
+            nibbles[row * 8 + column++] = static_cast<std::uint8_t>((type + 1) | (isBlack ? 8 : 0));
+            kingCounts[isBlack] += (pieceChars[type] == 'k' ? 1 : 0);
+            pawnCounts[isBlack] += (pieceChars[type] == 'p' ? 1 : 0);
+            ++pieceCounts[isBlack];
+        }
+    }
+    if (row != 0 || column != 8) throw std::invalid_argument("FEN placement doesn't have 8 ranks of 8 squares");
+    if (kingCounts[0] != 1 || kingCounts[1] != 1) throw std::invalid_argument("Each player must have exactly one king");
+    // also what keeps every count within Board's 4-bit material key fields
+    if (pieceCounts[0] > 16 || pieceCounts[1] > 16) throw std::invalid_argument("More than 16 pieces for one player");
+    if (pawnCounts[0] > 8 || pawnCounts[1] > 8) throw std::invalid_argument("More than 8 pawns for one player");
+
+    int slot = 0;
+    for (std::size_t square = 0; square < nibbles.size(); ++square) {
+        if (nibbles[square] == 0) continue;
+        if (slot == 32) throw std::invalid_argument("More than 32 pieces");
+        position.occupancy |= std::uint64_t{1} << square;
+        position.pieces[slot / 2] |= static_cast<std::uint8_t>(nibbles[square] << (4 * (slot % 2)));
+        ++slot;
+    }
+
+    if (activeColour != "w" && activeColour != "b") throw std::invalid_argument("FEN side to move must be 'w' or 'b'");
+    position.flags = (activeColour == "b" ? 1 : 0);
+    if (castling != "-") {
+        for (const char c : castling) {
+            static constexpr std::string_view castlingChars = "KQkq"; // in PackedPosition::flags order
+            const std::size_t bit = castlingChars.find(c);
+            if (bit == std::string_view::npos) throw std::invalid_argument(std::format("Invalid FEN castling field '{}'", castling));
+            position.flags |= static_cast<std::uint8_t>(1 << (bit + 1));
+        }
+    }
+
+    // FEN gives the square behind the pawn that moved two, the game keeps the pawn's own square
+    if (enPassant != "-") {
+        std::string square {enPassant};
+        if (!square.empty()) square[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(square[0]))); // Location wants "E3"
+        const Location target {square}; // throws std::invalid_argument
+        const gsl::index targetRow = target.getBoardRowIndex().value();
+        if (targetRow != 2 && targetRow != 5) throw std::invalid_argument(std::format("Invalid FEN en passant square '{}'", enPassant));
+        position.enPassantSquare = static_cast<std::uint8_t>(target.getSquareIndex() + (targetRow == 2 ? 8 : -8));
+    }
+
+    game.restoreSnapshot(position);
+    game.gameState = calculateGameState();
+    publishPosition();
+}
+
+void GameController::makeMove(const Move& move) noexcept {
+
+    if (game.network == nullptr) {
+        makeBoardMove(move);
+        return;
+    }
+
+    // with an evaluator attached, diff every square the move can touch and pass the changes to the accumulator
+    const Location source = move.getSource();
+    const Location destination = move.getDestination();
+    std::array<std::optional<Location>, 5> touchedSquares {source, destination};
+    if (game.enPassantTargetSquare != Location{} && game.enPassantTargetSquare != destination) { // (a normal capture of that pawn is already covered)
+        touchedSquares[2] = game.enPassantTargetSquare;
+    }
+    if (isCastling(source, destination)) {
+        std::tie(touchedSquares[3], touchedSquares[4]) = getCastlingRookMove(destination);
+    }
+
+    auto snapshot = [&]() {
+        std::array<std::optional<NnueNetwork::PieceOnSquare>, touchedSquares.size()> pieces;
+        for (size_t i = 0; i < touchedSquares.size(); ++i) {
+            if (!touchedSquares[i].has_value()) continue;
+            if (const Piece* piece = game.board.pieceAt(*touchedSquares[i])) {
+                pieces[i] = {piece->getType(), piece->getColour(), touchedSquares[i]->getSquareIndex()};
+            }
+        }
+        return pieces;
+    };
+
+    const auto before = snapshot();
+    makeBoardMove(move);
+    const auto after = snapshot();
+
+    NnueNetwork::DirtyPieces dirtyPieces;
+    for (size_t i = 0; i < touchedSquares.size(); ++i) {
+        const bool unchanged = (before[i].has_value() == after[i].has_value())
+                && (!before[i].has_value() || (before[i]->type == after[i]->type && before[i]->colour == after[i]->colour));
+        if (unchanged) continue;
+        if (before[i].has_value()) dirtyPieces.removed[dirtyPieces.removedCount++] = *before[i];
+        if (after[i].has_value()) dirtyPieces.added[dirtyPieces.addedCount++] = *after[i];
+    }
+    game.network->update(game.board, dirtyPieces, game.accumulator);
+}
+
+void GameController::makeBoardMove(const Move& move) noexcept {
 
     Board& board = game.board;
+    const Location source = move.getSource();
+    const Location destination = move.getDestination();
+    const bool isCastlingMove = isCastling(source, destination);
 
     board.erase(destination); // in case piece already there
-    board.insert(destination, std::move(board[source]));
-    board.erase(source);
+    board.insert(destination, board.extract(source));
 
     // logistics for special moves
 
@@ -56,33 +184,66 @@ void GameController::makeMove(const Location &source, const Location &destinatio
     }
 
     // 2. castling
-    if (King::isValidCastlingPath(source, destination)) {
+    if (isCastlingMove) {
         handleRookCastlingMove(destination);
         return;
     }
 
     // 3. pawn promotion
-    if (promotionPiece == nullptr) return;
+    const auto promotionType = move.getPromotionType();
+    if (!promotionType.has_value()) return;
+    const auto moversColour = board.pieceAt(destination)->getColour();
     board.erase(destination); // erase pawn at back row
-    board.insert(destination, promotionPiece->clone());
+    board.insert(destination, Piece::create(*promotionType, moversColour));
 }
 
-void GameController::submitMove(const Location &source, const Location &destination, const Piece* const promotionPiece = nullptr) noexcept {
+Game::MoveValidity GameController::validateMove(const Move& move) const noexcept {
+    // the legal move set is normally left over from the end of the last turn. Only a rejected move pays for working
+    // out why
+    if (getLegalMoves().contains(move)) return Game::MoveValidity::VALID;
+    const Game::MoveValidity validity = calcMoveValidity(game.activePlayer, move);
+    return (validity == Game::MoveValidity::VALID ? Game::MoveValidity::LEAVES_MOVER_IN_CHECK : validity);
+}
 
-    // pre-move validation <- TODO: Low priority, put calcMoveValidityStatus and moveLeavesMoverInCheck in one function
-    if (auto result = calcMoveValidityStatus(game.activePlayer, source, destination, promotionPiece); !result.isValid) {
-        gameView->displayException(std::runtime_error("ERROR: " + result.reason));
-        return;
+Game::MoveValidity GameController::submitMove(const Move& move) noexcept {
+
+    // the time is taken as the move arrives, so working out whether it's valid isn't charged to the mover
+    std::optional<ChessClock::Clock::time_point> now;
+    if (game.clock.has_value()) {
+        now = ChessClock::Clock::now();
+        if (game.clock->hasFlagFallen(*now)) {
+            endOnFlagFall();
+            gameView->displayInvalidMove(Game::MoveValidity::OUT_OF_TIME);
+            return Game::MoveValidity::OUT_OF_TIME;
+        }
     }
-    if (moveLeavesMoverInCheck(source, destination)) {
-        gameView->displayException(std::runtime_error("ERROR: Move leaves mover in check"));
-        return;
+
+    const Game::MoveValidity validity = validateMove(move); // pre-move validation
+    if (validity != Game::MoveValidity::VALID) {
+        gameView->displayInvalidMove(validity);
+        return validity;
     }
 
-    const std::unique_ptr<Piece> pieceMoved = game.board.pieceAt(source)->clone(); // now we know it's valid we're safe to assign pieceMoved
+    recordMove(move);
+    applyMove(move);
+    if (now.has_value()) {
+        game.clock->switchSides(*now);
+    }
+    if (feed != nullptr) {
+        game.gameState = calculateGameState(); // so spectators see mate straight away; playTurn() reuses the legal moves
+        publishPosition();
+    }
+
+    return validity;
+}
+
+void GameController::applyMove(const Move& move) noexcept {
+    const Location source = move.getSource();
+    const Location destination = move.getDestination();
+    const std::unique_ptr<Piece> pieceMoved = game.board.pieceAt(source)->clone();
 
     // move
-    makeMove(source, destination, promotionPiece);
+    makeMove(move);
 
     // post-move things that need sorting
     updateCastingAvailability(*pieceMoved, source);
@@ -90,64 +251,232 @@ void GameController::submitMove(const Location &source, const Location &destinat
     swapActivePlayer();
 }
 
+void GameController::recordMove(const Move& move) noexcept {
+    auto& history = game.history;
+    auto& plyCount = game.plyCount;
+
+    if (plyCount < history.size()) {
+        if (history[plyCount] == move) { // same as the undone move, so the rest of that line still holds
+            ++plyCount;
+            return;
+        }
+        history.resize(plyCount);
+        game.checkpoints.resize(std::min(game.checkpoints.size(), plyCount / Game::checkpointInterval + 1));
+    }
+    if (plyCount % Game::checkpointInterval == 0 && game.checkpoints.size() == plyCount / Game::checkpointInterval) {
+        game.checkpoints.push_back(game.takeSnapshot());
+    }
+    history.push_back(move);
+    ++plyCount;
+}
+
+bool GameController::undo() noexcept {
+    if (game.plyCount == 0) return false;
+    seekToPly(game.plyCount - 1);
+    return true;
+}
+
+bool GameController::redo() noexcept {
+    if (game.plyCount == game.history.size()) return false;
+    seekToPly(game.plyCount + 1);
+    return true;
+}
+
+void GameController::seekToPly(std::size_t ply) {
+    if (ply > game.history.size()) {
+        throw std::out_of_range(std::format("Can't seek to ply {}, the game has {}", ply, game.history.size()));
+    }
+    if (game.checkpoints.empty()) return; // nothing recorded, so `ply` is 0 and we're there
+
+    // NB: the checkpoint for a multiple of checkpointInterval is only taken once that ply is played
+    const std::size_t checkpoint = std::min(ply / Game::checkpointInterval, game.checkpoints.size() - 1);
+    const std::size_t checkpointPly = checkpoint * Game::checkpointInterval;
+    const bool isReplayFromCurrentShorter = game.plyCount <= ply && ply - game.plyCount <= ply - checkpointPly;
+
+    if (!isReplayFromCurrentShorter) {
+        game.restorePosition(game.checkpoints[checkpoint]);
+        game.plyCount = checkpointPly;
+    }
+    while (game.plyCount < ply) {
+        applyMove(game.history[game.plyCount++]);
+    }
+    game.gameState = calculateGameState();
+    publishPosition();
+}
+
+void GameController::restorePosition(const Game::PackedPosition& position, const std::optional<ChessClock>& clock) noexcept {
+    game.restoreSnapshot(position);
+    game.clock = clock;
+    publishPosition();
+}
+
+bool GameController::leavesMoverInCheck(const Move& move) const noexcept {
+    return moveLeavesMoverInCheck(move, calcCheckInfo(game.activePlayer), game.activePlayer);
+}
+
+void GameController::endOnFlagFall() noexcept {
+    /// FIDE rules (article 6.9): flag fall loses, unless the opponent couldn't mate by any series of legal moves. Only
+    /// the plain cases of that are covered: a lone king, or a king and one bishop or knight
+    using enum Piece::Type;
+    const Piece::Colour flagged = game.clock->getRunning();
+    const Piece::Colour opponent = (flagged == Piece::Colour::WHITE ? Piece::Colour::BLACK : Piece::Colour::WHITE);
+    const Board& board = game.board;
+    const bool canOpponentMate = board.getPieceCount(opponent, PAWN) + board.getPieceCount(opponent, ROOK) + board.getPieceCount(opponent, QUEEN) > 0
+            || board.getPieceCount(opponent, BISHOP) + board.getPieceCount(opponent, KNIGHT) > 1;
+
+    if (!canOpponentMate) {
+        game.gameState = Game::GameState::DRAW;
+    } else {
+        game.gameState = (opponent == Piece::Colour::WHITE ? Game::GameState::WHITE_WIN : Game::GameState::BLACK_WIN);
+    }
+    game.clock->stop();
+    publishPosition();
+}
+
+void GameController::publishPosition() noexcept {
+    if (feed != nullptr) {
+        feed->publish(game.takeSnapshot());
+    }
+}
+
 void GameController::swapActivePlayer() noexcept {
     game.activePlayer = ((game.activePlayer == game.whitePlayer) ? game.blackPlayer : game.whitePlayer);
 }
 
-GameController::MoveValidityStatus GameController::calcMoveValidityStatus(const Player& player, const Location &source, const Location &destination, const Piece* promotionPiece = nullptr) const noexcept {
+Game::MoveValidity GameController::calcMoveValidity(const Player& player, const Move& move) const noexcept {
     const auto& board = game.board;
+    const Location source = move.getSource();
+    const Location destination = move.getDestination();
     const auto& moversColour = player.getColour();
     const bool isDirectCapture = board.thereExistsPieceAt(destination); // i.e. capture that's not an en passant
 
     // universal conditions
 
     if (!board.thereExistsPieceAt(source)) {
-        return {.isValid = false, .reason = "No piece at source square"};
+        return Game::MoveValidity::NO_PIECE_AT_SOURCE;
     }
     if (board.pieceAt(source)->getColour() != moversColour) {
-        return {.isValid = false, .reason = "Moving wrong colour piece"};
+        return Game::MoveValidity::MOVING_WRONG_COLOUR;
     }
     if (board.thereExistsPieceAt(destination) && board[destination]->getColour() == moversColour) {
-        return {.isValid = false, .reason = "Can't take your own piece"};
+        return Game::MoveValidity::CAPTURING_OWN_PIECE;
     }
     if (!board[source]->isValidMovePath(source, destination, game.enPassantTargetSquare, isDirectCapture)) {
-        return {.isValid = false, .reason = "Piece can't move that way"};
+        return Game::MoveValidity::INVALID_MOVE_PATH;
     }
     if (board.isPathBlocked(source, destination)) {
-        return {.isValid = false, .reason = "Path blocked"};
+        return Game::MoveValidity::PATH_BLOCKED;
     }
 
     // piece-dependant conditions
 
     // castling
-    if (King::isValidCastlingPath(source, destination) && !isValidCastling(source, destination)) {
-        return {.isValid = false, .reason = "Invalid castling attempt"};
+    if (isCastling(source, destination) && !isValidCastling(source, destination)) {
+        return Game::MoveValidity::INVALID_CASTLING;
     }
 
     // pawn promotion
     if (isType<Pawn>(*board.pieceAt(source)) && isBackRow(destination, player)) { // if (pawn moves to back row) ...
-        const bool validPromotionPiece = isValidPromotionPiece(promotionPiece, player);
-        if (!validPromotionPiece) {
-            return {.isValid = false, .reason = "Invalid promotion piece"};
+        if (!isValidPromotionType(move.getPromotionType())) {
+            return Game::MoveValidity::INVALID_PROMOTION_PIECE;
         }
-        return {.isValid = true};
+        return Game::MoveValidity::VALID;
     }
-    if (promotionPiece) {
-        return {.isValid = false, .reason = "Move includes promotion piece but can't promote"};
+    if (move.getPromotionType().has_value()) {
+        return Game::MoveValidity::UNEXPECTED_PROMOTION_PIECE;
     }
 
-    return {.isValid = true};
+    return Game::MoveValidity::VALID;
 }
 
-bool GameController::moveLeavesMoverInCheck(const Location &source, const Location &destination) const noexcept {
+bool GameController::moveLeavesMoverInCheck(const Move& move) const noexcept {
 
     GameController copy {*this};
-    copy.makeMove(source, destination);
+    copy.makeMove(move);
     bool returnValue = copy.inCheck(copy.game.activePlayer);
 
     return returnValue;
 }
 
+bool GameController::moveLeavesMoverInCheck(const Move& move, const CheckInfo& checkInfo, const Player& player) const noexcept {
+    /// Same answer as moveLeavesMoverInCheck(move) but only falls back to making the move on a copy for castling
+    /// and en passant, where more than one piece moves
+
+    const Location source = move.getSource();
+    const Location destination = move.getDestination();
+    const Piece& pieceMoved = *game.board.pieceAt(source);
+
+    const bool isEnPassantCapture = isType<Pawn>(pieceMoved)
+            && game.enPassantTargetSquare == Location{source.getBoardRowIndex().value(), destination.getBoardColumnIndex().value()};
+    if (isCastling(source, destination) || isEnPassantCapture) {
+        return moveLeavesMoverInCheck(move);
+    }
+
+    if (isType<King>(pieceMoved)) {
+        const Player& opponent = (player.getColour() == Piece::Colour::WHITE ? game.blackPlayer : game.whitePlayer);
+        return isUnderAttackBy(destination, opponent, source); // source is vacated so sliders see through the king
+    }
+
+    if ((checkInfo.checkEvasionSquares & destination.getSquareBit()) == 0) {
+        return true;
+    }
+    const bool isPinned = (checkInfo.pinnedSquares & source.getSquareBit()) != 0;
+    return isPinned && !Location::areCollinear(checkInfo.kingLocation, source, destination);
+}
+
+GameController::CheckInfo GameController::calcCheckInfo(const Player& player) const noexcept {
+    const auto& board = game.board;
+    CheckInfo checkInfo {.kingLocation = getLocationOfKing(player)};
+    const auto [kingRow, kingColumn] = checkInfo.kingLocation;
+
+    // checkers
+    size_t checkerCount = 0;
+    for (const auto& [source, piece] : board) {
+        if (piece->getColour() == player.getColour() || !isAttacking(source, checkInfo.kingLocation)) continue;
+        if (++checkerCount > 1) {
+            checkInfo.checkEvasionSquares = 0; // double check, only the king can move
+            break;
+        }
+        checkInfo.checkEvasionSquares = source.getSquareBit();
+        if (isType<Knight>(*piece)) continue;
+        const auto [rowStep, columnStep] = Board::calculateMinimalDistanceMove(Location::calculateRowColumnDifferences(checkInfo.kingLocation, source));
+        for (Location between {kingRow.value() + rowStep, kingColumn.value() + columnStep}; between != source;
+             between = Location{between.getBoardRowIndex().value() + rowStep, between.getBoardColumnIndex().value() + columnStep}) {
+            checkInfo.checkEvasionSquares |= between.getSquareBit();
+        }
+    }
+
+    // pins: walk out from the king; an own piece followed by an enemy slider moving along that line is pinned
+    for (gsl::index rowStep = -1; rowStep <= 1; ++rowStep) {
+        for (gsl::index columnStep = -1; columnStep <= 1; ++columnStep) {
+            if (rowStep == 0 && columnStep == 0) continue;
+            const bool isDiagonalRay = (rowStep != 0 && columnStep != 0);
+
+            std::optional<Location> pinCandidate;
+            gsl::index row = kingRow.value() + rowStep;
+            gsl::index column = kingColumn.value() + columnStep;
+            for (; row >= 0 && row <= Location::getMaxRowIndex() && column >= 0 && column <= Location::getMaxColumnIndex();
+                   row += rowStep, column += columnStep) {
+                const Location location {row, column};
+                const Piece* piece = board.pieceAt(location);
+                if (piece == nullptr) continue;
+                if (piece->getColour() == player.getColour()) {
+                    if (pinCandidate.has_value()) break; // two own pieces shield the king
+                    pinCandidate = location;
+                    continue;
+                }
+                const bool slidesAlongRay = isType<Queen>(*piece) || (isDiagonalRay ? isType<Bishop>(*piece) : isType<Rook>(*piece));
+                if (pinCandidate.has_value() && slidesAlongRay) {
+                    checkInfo.pinnedSquares |= pinCandidate->getSquareBit();
+                }
+                break;
+            }
+        }
+    }
+
+    return checkInfo;
+}
+
 void GameController::setEnPassantTargetSquare(const Location &source, const Location &destination) noexcept {
     const Location::RowColumnDifferences locationDifferences = Location::calculateRowColumnDifferences(source, destination);
     game.enPassantTargetSquare = [&](){
@@ -160,21 +489,42 @@ void GameController::setEnPassantTargetSquare(const Location &source, const Loca
 
 bool GameController::isValidCastling(const Location &source, const Location &destination) const noexcept {
 
-    if (!King::isValidCastlingPath(source, destination)) return false;
+    if (!isCastling(source, destination)) return false;
+
+    const bool isWhite = (game.board.pieceAt(source)->getColour() == Piece::Colour::WHITE);
+    if (source != Location{isWhite ? "E1" : "E8"}) return false; // eg. a white king that has walked up to E8
+
+    // FIDE rules (article 3.8.2): not out of or through check. Into check is left to moveLeavesMoverInCheck(), as for
+    // any other king move
+    const Player& opponent = (isWhite ? game.blackPlayer : game.whitePlayer);
+    const Location crossedSquare {source.getBoardRowIndex().value(), (source.getBoardColumnIndex().value() + destination.getBoardColumnIndex().value()) / 2};
+    if (isUnderAttackBy(source, opponent) || isUnderAttackBy(crossedSquare, opponent)) return false;
+
+    // availability isn't revoked when a rook is captured on its starting square, so check it's still there
+    auto hasOwnRookAt = [&](const Location& rookLocation) {
+        const Piece* rook = game.board.pieceAt(rookLocation);
+        return rook != nullptr && isType<Rook>(*rook) && rook->getColour() == game.board.pieceAt(source)->getColour();
+    };
 
     if (destination == Location{"C1"}) {
-        return game.whiteCastlingAvailability.queenSide && !game.board.thereExistsPieceAt(Location{"B1"}); // !game.board.thereExistsPieceAt(Location{"B1"}) as not handled by isPathBlocked()
+        return game.whiteCastlingAvailability.queenSide && !game.board.thereExistsPieceAt(Location{"B1"}) && hasOwnRookAt(Location{"A1"}); // !game.board.thereExistsPieceAt(Location{"B1"}) as not handled by isPathBlocked()
     } else if (destination == Location{"C8"}) {
-        return game.blackCastlingAvailability.queenSide && !game.board.thereExistsPieceAt(Location{"B8"}); // !game.board.thereExistsPieceAt(Location{"B1"}) as not handled by isPathBlocked()
+        return game.blackCastlingAvailability.queenSide && !game.board.thereExistsPieceAt(Location{"B8"}) && hasOwnRookAt(Location{"A8"}); // !game.board.thereExistsPieceAt(Location{"B1"}) as not handled by isPathBlocked()
     } else if (destination == Location{"G1"}) {
-        return game.whiteCastlingAvailability.kingSide;
+        return game.whiteCastlingAvailability.kingSide && hasOwnRookAt(Location{"H1"});
     } else if (destination == Location{"G8"}) {
-        return game.blackCastlingAvailability.kingSide;
+        return game.blackCastlingAvailability.kingSide && hasOwnRookAt(Location{"H8"});
     }
 
     return false;
 }
 
+bool GameController::isCastling(const Location &source, const Location &destination) const noexcept {
+    // the path alone can't tell castling from a rook or queen moving two squares along the back row
+    const Piece* piece = game.board.pieceAt(source);
+    return piece != nullptr && isType<King>(*piece) && King::isValidCastlingPath(source, destination);
+}
+
 void GameController::updateCastingAvailability(const Piece& pieceMoved, const Location &source) noexcept {
     if (isType<King>(pieceMoved)) {
         if (game.activePlayer.getColour() == Piece::Colour::WHITE) {
@@ -209,26 +559,27 @@ bool GameController::isEnPassant(const Location &source, const Location &destina
 
 void GameController::handleRookCastlingMove(const Location &destination) noexcept{
     Board& board = game.board;
-    if (destination == Location{"C1"}) { //whiteCastingAvailability.queenSide;
-        board.insert(Location{"D1"}, board.pieceAt(Location{"A1"})->clone());
-        board.erase(Location{"A1"});
+    const auto [rookSource, rookDestination] = getCastlingRookMove(destination);
+    board.insert(rookDestination, board.extract(rookSource));
+}
+
+std::pair<Location, Location> GameController::getCastlingRookMove(const Location &kingDestination) noexcept {
+    if (kingDestination == Location{"C1"}) { //whiteCastingAvailability.queenSide;
+        return {Location{"A1"}, Location{"D1"}};
     }
-    else if (destination == Location{"G1"}) { //whiteCastingAvailability.kingSide;
-        board.insert(Location{"F1"}, board.pieceAt(Location{"H1"})->clone());
-        board.erase(Location{"H1"});
+    else if (kingDestination == Location{"G1"}) { //whiteCastingAvailability.kingSide;
+        return {Location{"H1"}, Location{"F1"}};
     }
-    else if (destination == Location{"C8"}) { //blackCastingAvailability.queenSide;
-        board.insert(Location{"D8"}, board.pieceAt(Location{"A8"})->clone());
-        board.erase(Location{"A8"});
+    else if (kingDestination == Location{"C8"}) { //blackCastingAvailability.queenSide;
+        return {Location{"A8"}, Location{"D8"}};
     }
-    else { // (destination == Location("G8")) //blackCastingAvailability.kingSide;
-        board.insert(Location{"F8"}, board.pieceAt(Location{"H8"})->clone());
-        board.erase(Location{"H8"});
+    else { // (kingDestination == Location("G8")) //blackCastingAvailability.kingSide;
+        return {Location{"H8"}, Location{"F8"}};
     }
 }
 
 Game::GameState GameController::calculateGameState() const noexcept{
-    if (thereExistsValidMove(game.activePlayer)) {
+    if (!getLegalMoves().empty()) { // NB: the full set rather than an early exit, as the next submitMove() reuses it
         // todo: implement additional draw conditions
         if (isDrawByInsufficientMaterial() /*|| isThreeFoldRepetition() || isFiftyMoveRule()*/) {
             return Game::GameState::DRAW;
@@ -247,19 +598,58 @@ Game::GameState GameController::calculateGameState() const noexcept{
     }
 }
 
-bool GameController::thereExistsValidMove(const Player& activePlayer) const noexcept{
-    GameController copy {*this};
-    for (const auto& [source, piece] : copy.game.board) {
+const MoveList& GameController::getLegalMoves() const noexcept {
+    const auto& cache = game.legalMoveCache;
+    const std::uint64_t boardMutationCount = game.board.getMutationCount();
+    const Piece::Colour colour = game.activePlayer.getColour();
+
+    if (!cache.has_value() || cache->boardMutationCount != boardMutationCount || cache->colour != colour) {
+        game.legalMoveCache = Game::LegalMoveCache{calcValidMoves(game.activePlayer), boardMutationCount, colour};
+    }
+    return game.legalMoveCache->moves;
+}
+
+std::vector<Location> GameController::getLegalDestinations(const Location& source) const noexcept {
+    std::uint64_t destinationSquares = 0; // a set, so the four promotions to a square count once
+    for (const Move& move : getLegalMoves()) {
+        if (move.getSourceIndex() == source.getSquareIndex()) {
+            destinationSquares |= std::uint64_t{1} << move.getDestinationIndex();
+        }
+    }
+
+    std::vector<Location> destinations;
+    for (gsl::index squareIndex = 0; squareIndex < Location::getSquareCount(); ++squareIndex) {
+        if ((destinationSquares >> squareIndex) & 1) {
+            destinations.push_back(Location::fromSquareIndex(squareIndex));
+        }
+    }
+    return destinations;
+}
+
+MoveList GameController::calcValidMoves(const Player& activePlayer) const noexcept {
+    const CheckInfo checkInfo = calcCheckInfo(activePlayer);
+    MoveList validMoves;
+    for (const auto& [source, piece] : game.board) {
         if (piece->getColour() != activePlayer.getColour()) continue;
-        for (Location destination = Location{"A1"}; destination <= Location{"H8"}; ++destination) {
-            if (copy.calcMoveValidityStatus(activePlayer, source, destination).isValid
-            && !copy.moveLeavesMoverInCheck(source, destination)) {
-                return true;
+        const bool isPawn = isType<Pawn>(*piece);
+        for (gsl::index destinationIndex = 0; destinationIndex < Location::getSquareCount(); ++destinationIndex) {
+            const Location destination = Location::fromSquareIndex(destinationIndex);
+            if (isPawn && isBackRow(destination, activePlayer)) {
+                for (const auto promotionType : {Piece::Type::QUEEN, Piece::Type::ROOK, Piece::Type::BISHOP, Piece::Type::KNIGHT}) {
+                    const Move move {source, destination, promotionType};
+                    if (isValidMove(activePlayer, move) && !moveLeavesMoverInCheck(move, checkInfo, activePlayer)) {
+                        validMoves.push_back(move);
+                    }
+                }
+                continue;
+            }
+            const Move move {source, destination};
+            if (isValidMove(activePlayer, move) && !moveLeavesMoverInCheck(move, checkInfo, activePlayer)) {
+                validMoves.push_back(move);
             }
-
         }
     }
-    return false;
+    return validMoves;
 }
 
 void GameController::initGameLoop() noexcept {
@@ -269,20 +659,51 @@ void GameController::initGameLoop() noexcept {
 
         try {
             gameView->displayTurn(game.activePlayer);
-
-            const auto& [source, destination, promotionPiece] = getMoveInfoFromUser();
-            const Player preMoveActivePlayer = game.activePlayer;
-
-            submitMove(source, destination, promotionPiece.get());
-            // TODO: Low priority, submitMove -> bool submitMoveAndReturnSuccessStatus()??
-            if (preMoveActivePlayer != game.activePlayer) {
-                game.gameState = calculateGameState();
-            }
+            playTurn(getMoveFromUser());
         }
         catch (const std::exception& e) {
             gameView->displayException(e);
         }
     }
+    displayResult();
+}
+
+Game::MoveValidity GameController::playTurn(const Move &move) noexcept {
+    const Game::MoveValidity validity = submitMove(move);
+    if (validity == Game::MoveValidity::VALID) {
+        game.gameState = calculateGameState();
+        if (game.gameState != Game::GameState::IN_PROGRESS && game.clock.has_value()) {
+            game.clock->stop();
+        }
+    }
+    return validity;
+}
+
+void GameController::startClock(const TimeControl& timeControl, TimerWheel* wheel, std::uint64_t timerTag) {
+    if (game.clock.has_value()) {
+        game.clock->stop();
+    }
+    game.clock.emplace(timeControl, game.activePlayer.getColour(), ChessClock::Clock::now());
+    if (wheel != nullptr) {
+        game.clock->attachTimer(*wheel, timerTag);
+    }
+}
+
+bool GameController::checkFlagFall() noexcept {
+    if (!game.clock.has_value() || game.gameState != Game::GameState::IN_PROGRESS
+        || !game.clock->hasFlagFallen(ChessClock::Clock::now())) {
+        return false;
+    }
+    endOnFlagFall();
+    return true;
+}
+
+void GameController::displayPosition() const noexcept {
+    gameView->viewBoard(game.board);
+    gameView->displayTurn(game.activePlayer);
+}
+
+void GameController::displayResult() const noexcept {
     gameView->viewBoard(game.board);
     gameView->displayEndOfGameMessage(game.gameState);
 }
@@ -311,28 +732,17 @@ void GameController::manualSetup() noexcept {
 
     }
 
-    const bool eachHaveExactlyOneKing = std::invoke([&](){
-        const auto& board = game.board.board;
-
-        size_t whiteKingCount = 0, blackKingCount = 0;
-
-        std::for_each(cbegin(board), cend(board), [&](const auto& it){
-            const auto& piece = it.second;
-            if (isType<King>(*piece)) {
-                (piece->getColour() == Piece::Colour::WHITE) ? ++whiteKingCount : ++blackKingCount;
-            }
-        });
-
-        return whiteKingCount == 1 && blackKingCount == 1;
-    });
+    const bool eachHaveExactlyOneKing = game.board.getPieceCount(Piece::Colour::WHITE, Piece::Type::KING) == 1
+            && game.board.getPieceCount(Piece::Colour::BLACK, Piece::Type::KING) == 1;
 
     if (!eachHaveExactlyOneKing) {
         gameView->displayException(std::runtime_error("Invalid Position: Each player must have exactly one king. Clearing board..."));
-        game.board.board.clear();
+        game.board.clear();
         return;
     }
 
     game.activePlayer = getStartingPlayer();
+    game.refreshAccumulator();
 }
 
 GameController::GameController(const GameController &rhs)
@@ -340,7 +750,7 @@ GameController::GameController(const GameController &rhs)
 
 GameController &GameController::operator=(const GameController &rhs) {
     gameView = rhs.gameView->clone();
-    game.board.board.clear(); // bug fix for moveLeavesMoverInCheck() where `*this = copy` didn't remove the moved piece
+    game.board.clear(); // bug fix for moveLeavesMoverInCheck() where `*this = copy` didn't remove the moved piece
     game = rhs.game;
     return *this;
 }
@@ -365,14 +775,15 @@ bool GameController::isBackRow(const Location &square, const Player &player) con
     return square.getBoardRowIndex() == 0;
 }
 
-Game::MoveInfo GameController::getMoveInfoFromUser() const noexcept {
+Move GameController::getMoveFromUser() const noexcept {
 
     const auto source = getLocationFromUser("Type source square: ");
     const auto destination = getLocationFromUser("Type destination square: ");
 
-    auto promotionPiece = std::invoke([&]() -> std::unique_ptr<Piece> {
-        if (!isType<Pawn>(*game.board.pieceAt(source)) || !isBackRow(destination, game.activePlayer)) {
-            return nullptr;
+    auto promotionType = std::invoke([&]() -> std::optional<Piece::Type> {
+        const Piece* pieceMoved = game.board.pieceAt(source);
+        if (pieceMoved == nullptr || !isType<Pawn>(*pieceMoved) || !isBackRow(destination, game.activePlayer)) {
+            return std::nullopt;
         }
         while (true) {
             auto piece = getPieceFromUser("Enter promotion piece char (eg. 'Q', 'R'): ");
@@ -380,7 +791,7 @@ Game::MoveInfo GameController::getMoveInfoFromUser() const noexcept {
             if (!isType<King>(*piece)
                 && !isType<Pawn>(*piece)
                 && piece->getColour() == game.activePlayer.getColour()){
-                return piece;
+                return piece->getType();
             } else {
                 gameView->displayException(std::runtime_error("Invalid Promotion Piece (wrong piece type and/or colour)"));
             }
@@ -388,7 +799,7 @@ Game::MoveInfo GameController::getMoveInfoFromUser() const noexcept {
 
     });
 
-    return {source, destination, std::move(promotionPiece)};
+    return {source, destination, promotionType};
 }
 
 Location GameController::getLocationFromUser(std::string_view message) const noexcept {
@@ -416,31 +827,34 @@ std::unique_ptr<Piece> GameController::getPieceFromUser(std::string_view message
 }
 
 Location GameController::getLocationOfKing(const Player &player) const noexcept {
-    const auto& board = game.board.board;
-    const auto& kingColour = player.getColour();
-
-    auto it = std::find_if(board.begin(), board.end(), [&](const auto& entry) {
-        const auto& piece = entry.second;
-        return (piece->getColour() == kingColour) && (isType<King>(*piece));
-    });
-
-    return (it != board.end() ? it->first : Location{});
+    return game.board.getKingLocation(player.getColour());
 }
 
-bool GameController::isUnderAttackBy(Location target, const Player &opponent) const noexcept {
-    // NB: a square isn't marked as under attack if the attacker has a piece there.
-    // En passant target squares are also not accounted for, but as isUnderAttack is a used in inCheck() and validMove()
+bool GameController::isUnderAttackBy(Location target, const Player &opponent, const Location& vacated) const noexcept {
+    // NB: En passant target squares are not accounted for, but as isUnderAttack is a used in inCheck()
     // and you cant castle through an en passant target square, this is a moot issue
     const auto& board = game.board.board;
     auto isOpponentPieceAttackingTarget = [&](const auto& it) -> bool {
         const auto& [source, sourcePiece] = it;
         if (sourcePiece.get()->getColour() != opponent.getColour()) return false;
-        return calcMoveValidityStatus(opponent, source, target).isValid;
+        return isAttacking(source, target, vacated);
     };
 
     return std::any_of(board.cbegin(), board.cend(), isOpponentPieceAttackingTarget);
 }
 
+bool GameController::isAttacking(const Location &source, const Location &target, const Location& vacated) const noexcept {
+    /// Whether the piece at `source` could capture on `target`. Unlike calcMoveValidity() this ignores what's on
+    /// `target`, so pawns still attack their promotion squares and kings never "attack" via a castling path
+    const Piece* piece = game.board.pieceAt(source);
+    if (piece == nullptr || source == target) return false;
+    if (isType<King>(*piece)) {
+        return Location::maxAbsoluteRowColumnDifference(source, target) == 1;
+    }
+    return piece->isValidMovePath(source, target, Location{}, true)
+        && !game.board.isPathBlocked(source, target, vacated);
+}
+
 Player GameController::getStartingPlayer() const noexcept {
     while (true) {
         const char startColour = toupper(gameView->readInput("Enter starting colour ('W' or 'B'): ")[0], std::locale());
@@ -466,39 +880,25 @@ bool GameController::isDrawByInsufficientMaterial() const noexcept {
      * TODO: Low priority, Integrate a 'helpmate analyser' to fix this.
      */
 
-     const bool thereExistsAPawnOrMajorPiece = [&](){
-         auto& board = game.board.board;
-         return std::any_of(begin(board), end(board), [](const auto& it) {
-             const auto& piece = it.second;
-             return isType<Rook>(*piece) || isType<Queen>(*piece) || isType<Pawn>(*piece);
-         });
-     }();
-
-    if (thereExistsAPawnOrMajorPiece) return false;
+    // NB: counts are kept up to date by the board, so no scan is needed
+    const Board& board = game.board;
+    using enum Piece::Type;
+    for (const auto colour : {Piece::Colour::WHITE, Piece::Colour::BLACK}) {
+        if (board.getPieceCount(colour, PAWN) + board.getPieceCount(colour, ROOK) + board.getPieceCount(colour, QUEEN) > 0) {
+            return false;
+        }
+    }
 
     struct MinorPieceCount {
         size_t whiteBishopCount, whiteKnightCount, blackBishopCount, blackKnightCount;
     };
 
-    const MinorPieceCount minorPieceCount = [&](){
-
-        MinorPieceCount count {0,0,0,0};
-
-        auto& board = game.board.board;
-
-        std::for_each(cbegin(board), cend(board), [&](const auto& it){
-            const auto& piece = it.second;
-            if (isType<Bishop>(*piece)) {
-                (piece->getColour() == Piece::Colour::WHITE) ? ++count.whiteBishopCount : ++count.blackBishopCount;
-            }
-            else if (isType<Knight>(*piece)) {
-                (piece->getColour() == Piece::Colour::WHITE) ? ++count.whiteKnightCount : ++count.blackKnightCount;
-            }
-        });
-
-        return count;
-
-    }();
+    const MinorPieceCount minorPieceCount {
+        .whiteBishopCount = static_cast<size_t>(board.getPieceCount(Piece::Colour::WHITE, BISHOP)),
+        .whiteKnightCount = static_cast<size_t>(board.getPieceCount(Piece::Colour::WHITE, KNIGHT)),
+        .blackBishopCount = static_cast<size_t>(board.getPieceCount(Piece::Colour::BLACK, BISHOP)),
+        .blackKnightCount = static_cast<size_t>(board.getPieceCount(Piece::Colour::BLACK, KNIGHT))
+    };
 
     const auto totalWhiteMinorPieces = minorPieceCount.whiteBishopCount + minorPieceCount.whiteKnightCount;
     const auto totalBlackMinorPieces = minorPieceCount.blackBishopCount + minorPieceCount.blackKnightCount;
@@ -528,13 +928,6 @@ bool GameController::isDrawByInsufficientMaterial() const noexcept {
     return false;
 }
 
-void GameController::displayAllUnderAttackBy(const Player &player) noexcept {
-    Game copy {game};
-    copy.board.board.clear();
-    for (Location i = Location{"A1"}; i <= Location{"H8"}; ++i) {
-        if (isUnderAttackBy(i, player)) {
-            copy.board.insert(i, std::make_unique<Pawn>(Piece::Colour::WHITE));
-        }
-    }
-    gameView->viewBoard(copy.board);
+void GameController::displayAttackMap() const noexcept {
+    gameView->displayAttackMap(calcAttackMap(game.board));
 }
@@ -1,21 +1,29 @@
 #pragma once
 
 #include "Game.h"
+#include "Move.h"
 #include "GameView.h"
+#include "Analysis.h"
+
+class PositionFeed;
 
 using PieceFactory = std::function<std::unique_ptr<Piece>(Piece::Colour)>;
 
 class GameController {
 
-    struct MoveValidityStatus {
-        bool isValid;
-        std::string reason;
+    /// STRUCTS
+    // Computed once per position so most candidate moves can be judged without making them on a copy
+    struct CheckInfo {
+        Location kingLocation;
+        std::uint64_t pinnedSquares {0};             // own pieces that may only move along the line to their king
+        std::uint64_t checkEvasionSquares {~0ULL};   // non-king moves must land here (checker + blocking squares)
     };
 
     /// DATA MEMBERS
     Game game;
     std::unique_ptr<GameView> gameView = std::make_unique<GameViewCLI>();
     static const std::map<char, PieceFactory> pieceFactories;
+    PositionFeed* feed {nullptr}; // not copied: copies are scratch positions nobody is watching
 
     /// CONSTRUCTORS / OVERLOADS
 public:
@@ -29,19 +37,70 @@ public:
     void setup() noexcept;
     void manualSetup() noexcept;
     void setupSimple() noexcept; // TODO: remove from public API
+    void setupFromFen(std::string_view fen); // Throws std::invalid_argument. The move counters are optional and ignored
+
+    /// EVALUATION
+    void attachEvaluator(std::shared_ptr<const NnueNetwork> network) noexcept { game.attachNetwork(std::move(network)); }
+    [[nodiscard]] int evaluate() const { return game.evaluate(); }
 
     /// MISC.
-    // TODO: submitMove(...) -> submitMove(Game::MoveInfo)
-    void submitMove(const Location &source, const Location &destination, const Piece* promotionPiece) noexcept;
+    [[nodiscard]] Game::MoveValidity validateMove(const Move& move) const noexcept; // what submitMove() would say, without moving
+    Game::MoveValidity submitMove(const Move& move) noexcept;
     void initGameLoop() noexcept;
-    void displayAllUnderAttackBy(const Player& player) noexcept;
+
+    // One iteration of initGameLoop(), for callers that get moves from somewhere other than GameView::readInput()
+    Game::MoveValidity playTurn(const Move& move) noexcept;
+    void displayPosition() const noexcept;
+    void displayResult() const noexcept;
+    [[nodiscard]] Game::GameState getGameState() const noexcept { return game.gameState; }
+    [[nodiscard]] const Game& getGame() const noexcept { return game; }
+
+    // Both come from one legal move set per position, cached on the Game until the board or side to move changes
+    [[nodiscard]] const MoveList& getLegalMoves() const noexcept;
+    [[nodiscard]] std::vector<Location> getLegalDestinations(const Location& source) const noexcept;
+    void displayAttackMap() const noexcept; // both colours' attacker counts per square
+
+    /// CLOCK
+    // Times the game from now. With a wheel, flag fall is reported to the wheel's owner under `timerTag`
+    void startClock(const TimeControl& timeControl, TimerWheel* wheel = nullptr, std::uint64_t timerTag = 0);
+    // Ends the game if the side to move has run out of time, eg. when the clock's timer fires. NB: a move that
+    // arrives after flag fall is turned down with OUT_OF_TIME whether or not this has been called
+    bool checkFlagFall() noexcept;
+
+    /// SPECTATORS
+    // Every later change of position (moves, undo/redo, flag fall, setupFromFen(), restorePosition()) is published to `positionFeed`, which
+    // must outlive this or be detached with nullptr. Not owned
+    void attachFeed(PositionFeed* positionFeed) noexcept { feed = positionFeed; }
+
+    /// HISTORY
+    bool undo() noexcept; // false if already at the start
+    bool redo() noexcept; // false if there's no undone move to replay
+    // Replays at most Game::checkpointInterval plies from the nearest checkpoint (or the current position, if closer).
+    // 0 = position before the first recorded move. Throws std::out_of_range past the last recorded ply
+    void seekToPly(std::size_t ply);
+
+    /// SCRATCH POSITIONS
+    // For code that steps a scratch controller through many positions (eg. Perft, SessionStore). All are for the side
+    // to move, and none of them record history, run the clock, update the game state or show anything
+    void restorePosition(const Game::PackedPosition& position, const std::optional<ChessClock>& clock = std::nullopt) noexcept; // drops the history
+    void applyMoveUnchecked(const Move& move) noexcept { applyMove(move); } // a legal move, eg. from calcLegalMoves()
+    [[nodiscard]] MoveList calcLegalMoves() const noexcept { return calcValidMoves(game.activePlayer); } // uncached, unlike getLegalMoves()
+    [[nodiscard]] Game::GameState calcGameState() const noexcept { return calculateGameState(); }
+    [[nodiscard]] bool isInCheck() const noexcept { return inCheck(game.activePlayer); }
+    // Every rule but check, which leavesMoverInCheck() covers, so the two together give validateMove()'s answer
+    // without the legal move set
+    [[nodiscard]] Game::MoveValidity calcMoveValidity(const Move& move) const noexcept { return calcMoveValidity(game.activePlayer, move); }
+    [[nodiscard]] bool leavesMoverInCheck(const Move& move) const noexcept; // `move` must pass calcMoveValidity()
 
 private:
 
     /// VALIDATION
-    // TODO: isValidMove(Player, ...) -> submitMove(Player, Game::MoveInfo)    
-    [[nodiscard]] GameController::MoveValidityStatus calcMoveValidityStatus(const Player& player, const Location &source, const Location &destination, const Piece *promotionPiece) const noexcept;
+    [[nodiscard]] Game::MoveValidity calcMoveValidity(const Player& player, const Move& move) const noexcept;
+    [[nodiscard]] bool isValidMove(const Player& player, const Move& move) const noexcept {
+        return calcMoveValidity(player, move) == Game::MoveValidity::VALID;
+    }
     [[nodiscard]] bool isValidCastling(const Location &source, const Location &destination) const noexcept;
+    [[nodiscard]] bool isCastling(const Location &source, const Location &destination) const noexcept; // a king's castling move, legal or not
     [[nodiscard]] bool isEnPassant(const Location &source, const Location &destination) const noexcept;
     [[nodiscard]] bool isBackRow(const Location& square, const Player& player) const noexcept;
 
@@ -50,28 +109,26 @@ private:
         return dynamic_cast<const T*>(&piece);
     }
 
-    [[nodiscard]] static bool isValidPromotionPiece(const Piece* promotionPiece, const Player &player) noexcept {
-        if (promotionPiece == nullptr) return false;
-        if (isType<King>(*promotionPiece)
-            || isType<Pawn>(*promotionPiece)
-            || promotionPiece->getColour() != player.getColour()) {
-            return false;
-        }
-        return true;
+    [[nodiscard]] static bool isValidPromotionType(std::optional<Piece::Type> promotionType) noexcept {
+        if (!promotionType.has_value()) return false;
+        return promotionType != Piece::Type::KING && promotionType != Piece::Type::PAWN;
     }
     /// CHECK
     [[nodiscard]] bool inCheck(const Player& player) const noexcept;
-    [[nodiscard]] bool moveLeavesMoverInCheck(const Location &source, const Location &destination) const noexcept;
+    [[nodiscard]] bool moveLeavesMoverInCheck(const Move& move) const noexcept;
+    [[nodiscard]] bool moveLeavesMoverInCheck(const Move& move, const CheckInfo& checkInfo, const Player& player) const noexcept;
+    [[nodiscard]] CheckInfo calcCheckInfo(const Player& player) const noexcept;
 
     /// GET / CALCULATE
 
     [[nodiscard]] Location getLocationOfKing(const Player& player) const noexcept;
     [[nodiscard]] Game::GameState calculateGameState() const noexcept;
-    [[nodiscard]] bool isUnderAttackBy(Location target, const Player& opponent) const noexcept;
-    [[nodiscard]] bool thereExistsValidMove(const Player& activePlayer) const noexcept;
+    [[nodiscard]] bool isUnderAttackBy(Location target, const Player& opponent, const Location& vacated = Location{}) const noexcept;
+    [[nodiscard]] bool isAttacking(const Location& source, const Location& target, const Location& vacated = Location{}) const noexcept;
+    [[nodiscard]] MoveList calcValidMoves(const Player& activePlayer) const noexcept;
 
     /// ... get from user
-    [[nodiscard]] Game::MoveInfo getMoveInfoFromUser() const noexcept;
+    [[nodiscard]] Move getMoveFromUser() const noexcept;
     [[nodiscard]] Location getLocationFromUser(std::string_view message) const noexcept;
     [[nodiscard]] std::unique_ptr<Piece> getPieceFromUser(std::string_view message) const noexcept;
 
@@ -79,14 +136,19 @@ private:
 
 
     /// MANIPULATE GAME / BOARD
-    // TODO: makeMove(...) -> makeMove(Game::MoveInfo)
-    void makeMove(const Location &source, const Location &destination, const Piece* promotionPiece) noexcept;
+    void applyMove(const Move& move) noexcept; // a validated move, with everything that follows it except the game state
+    void recordMove(const Move& move) noexcept; // to the history, before applyMove()
+    void makeMove(const Move& move) noexcept;
+    void makeBoardMove(const Move& move) noexcept; // board changes only; makeMove() also keeps the evaluator in sync
 
     void setEnPassantTargetSquare(const Location &source, const Location &destination) noexcept;
     void updateCastingAvailability(const Piece& pieceMoved, const Location &source) noexcept;
     void handleRookCastlingMove(const Location &destination) noexcept;
+    [[nodiscard]] static std::pair<Location, Location> getCastlingRookMove(const Location &kingDestination) noexcept; // {source, destination}
 
     void swapActivePlayer() noexcept;
+    void endOnFlagFall() noexcept; // the running side loses, or it's a draw if the other side can't possibly mate
+    void publishPosition() noexcept; // to the feed, if any
 
     /// MISC.
     static std::map<char, PieceFactory> createPieceFactories() noexcept;
@@ -0,0 +1,148 @@
+#include "GameRecord.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include "format"
+
+// Carry-less range coder (Subbotin): renormalise a byte at a time while the top byte of the interval is settled
+static constexpr std::uint32_t rangeTop = std::uint32_t{1} << 24;
+static constexpr std::uint32_t rangeBottom = std::uint32_t{1} << 16;
+
+// The current position's legal moves in the order their indices refer to
+static MoveList calcOrderedLegalMoves(const GameController& controller) noexcept {
+    MoveList moves = controller.getLegalMoves();
+    std::sort(moves.begin(), moves.end(), [](const Move& a, const Move& b) { return a.getRaw() < b.getRaw(); });
+    return moves;
+}
+
+/// MOVE INDEX MODEL
+
+std::uint32_t MoveIndexModel::calcCumulative(std::size_t symbol) const noexcept {
+    std::uint32_t cumulative = 0;
+    for (std::size_t i = 0; i < symbol; ++i) {
+        cumulative += frequencies[i];
+    }
+    return cumulative;
+}
+
+void MoveIndexModel::update(std::size_t symbol) noexcept {
+    frequencies[symbol] += increment;
+    total += increment;
+    if (total > maxTotal - increment) { // halve, keeping every symbol codable
+        total = 0;
+        for (auto& frequency : frequencies) {
+            frequency = (frequency + 1) / 2;
+            total += frequency;
+        }
+    }
+}
+
+/// ENCODER
+
+GameRecordEncoder::GameRecordEncoder() : controller{new GameViewCLI} {
+    controller.setup();
+}
+
+void GameRecordEncoder::add(const Move& move) {
+    if (isFinished) {
+        throw std::logic_error("Game record already finished");
+    }
+    const MoveList moves = calcOrderedLegalMoves(controller);
+    const auto found = std::lower_bound(moves.begin(), moves.end(), move, [](const Move& a, const Move& b) { return a.getRaw() < b.getRaw(); });
+    if (found == moves.end() || *found != move) {
+        throw std::invalid_argument(std::format("{} isn't legal at ply {}", static_cast<std::string>(move), controller.getGame().getPlyCount() + 1));
+    }
+
+    encode(static_cast<std::size_t>(found - moves.begin()), moves.size());
+    controller.playTurn(move);
+}
+
+std::vector<std::uint8_t> GameRecordEncoder::finish() {
+    if (isFinished) {
+        throw std::logic_error("Game record already finished");
+    }
+    const std::size_t legalMoveCount = controller.getLegalMoves().size();
+    encode(legalMoveCount, legalMoveCount);
+    for (int i = 0; i < 4; ++i) {
+        bytes.push_back(static_cast<std::uint8_t>(low >> 24));
+        low <<= 8;
+    }
+    isFinished = true;
+    return std::move(bytes);
+}
+
+void GameRecordEncoder::encode(std::size_t symbol, std::size_t legalMoveCount) noexcept {
+    // only indices that can occur in this position (plus the end marker) share the range
+    const std::uint32_t total = model.calcCumulative(legalMoveCount + 1);
+    range /= total;
+    low += model.calcCumulative(symbol) * range;
+    range *= model.getFrequency(symbol);
+    while ((low ^ (low + range)) < rangeTop || (range < rangeBottom && ((range = -low & (rangeBottom - 1)), true))) {
+        bytes.push_back(static_cast<std::uint8_t>(low >> 24));
+        low <<= 8;
+        range <<= 8;
+    }
+    model.update(symbol);
+}
+
+std::vector<std::uint8_t> encodeGameRecord(std::span<const Move> moves) {
+    GameRecordEncoder encoder;
+    for (const Move& move : moves) {
+        encoder.add(move);
+    }
+    return encoder.finish();
+}
+
+/// DECODER
+
+GameRecordDecoder::GameRecordDecoder(std::span<const std::uint8_t> record) : controller{new GameViewCLI}, bytes{record} {
+    controller.setup();
+    for (int i = 0; i < 4; ++i) {
+        code = (code << 8) | readByte();
+    }
+}
+
+std::optional<Move> GameRecordDecoder::next() {
+    if (isFinished) return std::nullopt;
+
+    const MoveList moves = calcOrderedLegalMoves(controller);
+    const std::size_t index = decode(moves.size());
+    if (index == moves.size()) {
+        isFinished = true;
+        return std::nullopt;
+    }
+    controller.playTurn(moves[index]);
+    return moves[index];
+}
+
+std::size_t GameRecordDecoder::decode(std::size_t legalMoveCount) {
+    const std::uint32_t total = model.calcCumulative(legalMoveCount + 1);
+    range /= total;
+    const std::uint32_t value = (code - low) / range;
+    if (value >= total) {
+        throw std::invalid_argument("Corrupt game record");
+    }
+
+    std::size_t symbol = 0;
+    std::uint32_t cumulative = 0;
+    while (cumulative + model.getFrequency(symbol) <= value) {
+        cumulative += model.getFrequency(symbol++);
+    }
+
+    low += cumulative * range;
+    range *= model.getFrequency(symbol);
+    while ((low ^ (low + range)) < rangeTop || (range < rangeBottom && ((range = -low & (rangeBottom - 1)), true))) {
+        code = (code << 8) | readByte();
+        low <<= 8;
+        range <<= 8;
+    }
+    model.update(symbol);
+    return symbol;
+}
+
+std::uint8_t GameRecordDecoder::readByte() {
+    if (nextByte == bytes.size()) {
+        throw std::invalid_argument("Truncated game record");
+    }
+    return bytes[nextByte++];
+}
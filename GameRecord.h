@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "GameController.h"
+
+/* Compact archive format for games played from the standard starting position.
+
+ Each move is stored as its index in that position's legal moves sorted by Move::getRaw() (so the format doesn't
+ depend on the order moves are generated in), followed by an end marker with index = the number of legal moves. The
+ indices are range coded with an adaptive model, which comes to a few bits per ply; there's no header, so games can
+ be encoded and decoded one ply at a time.
+*/
+
+/// Adaptive frequencies of move indices, updated identically by the encoder and decoder
+class MoveIndexModel {
+public:
+    static constexpr std::size_t symbolCount = MoveList::capacity; // every index plus the end marker fits below this
+
+private:
+    static constexpr std::uint32_t increment = 24;
+    static constexpr std::uint32_t maxTotal = std::uint32_t{1} << 16; // the range coder's limit
+
+    /// DATA MEMBERS
+    std::array<std::uint32_t, symbolCount> frequencies;
+    std::uint32_t total;
+
+public:
+    /// CONSTRUCTORS
+    MoveIndexModel() noexcept { frequencies.fill(1); total = symbolCount; }
+
+    /// GETTERS
+    [[nodiscard]] std::uint32_t getFrequency(std::size_t symbol) const noexcept { return frequencies[symbol]; }
+    // Cumulative frequency of the symbols below `symbol`
+    [[nodiscard]] std::uint32_t calcCumulative(std::size_t symbol) const noexcept;
+
+    /// MISC.
+    void update(std::size_t symbol) noexcept;
+};
+
+class GameRecordEncoder {
+    /// DATA MEMBERS
+    GameController controller;
+    MoveIndexModel model;
+    std::vector<std::uint8_t> bytes;
+    std::uint32_t low {0};
+    std::uint32_t range {~std::uint32_t{0}};
+    bool isFinished = false;
+
+public:
+    /// CONSTRUCTORS
+    GameRecordEncoder();
+
+    /// ENCODING
+    void add(const Move& move); // Throws std::invalid_argument if `move` isn't legal in the current position
+    [[nodiscard]] std::vector<std::uint8_t> finish(); // writes the end marker. Throws std::logic_error if called twice
+
+    /// GETTERS
+    [[nodiscard]] const Game& getGame() const noexcept { return controller.getGame(); } // after the moves added so far
+    [[nodiscard]] const MoveList& getLegalMoves() const noexcept { return controller.getLegalMoves(); } // generation order
+
+private:
+    void encode(std::size_t symbol, std::size_t legalMoveCount) noexcept;
+};
+
+/// Plays a record's moves into a Game one at a time, without decoding the rest of the record first
+class GameRecordDecoder {
+    /// DATA MEMBERS
+    GameController controller;
+    MoveIndexModel model;
+    std::span<const std::uint8_t> bytes;
+    std::size_t nextByte {0};
+    std::uint32_t low {0};
+    std::uint32_t range {~std::uint32_t{0}};
+    std::uint32_t code {0};
+    bool isFinished = false;
+
+public:
+    /// CONSTRUCTORS
+    explicit GameRecordDecoder(std::span<const std::uint8_t> record); // `record` must outlive the decoder
+
+    /// DECODING
+    // The next move, already played into getGame(); std::nullopt once the end marker is reached.
+    // Throws std::invalid_argument if the record is corrupt
+    std::optional<Move> next();
+    [[nodiscard]] const Game& getGame() const noexcept { return controller.getGame(); }
+
+private:
+    [[nodiscard]] std::size_t decode(std::size_t legalMoveCount);
+    [[nodiscard]] std::uint8_t readByte(); // the decoder reads exactly as many bytes as the encoder wrote
+};
+
+[[nodiscard]] std::vector<std::uint8_t> encodeGameRecord(std::span<const Move> moves);
@@ -0,0 +1,515 @@
+#include "GameServer.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/// GAME VIEW PROTOCOL
+
+void GameViewProtocol::viewBoard(const Board &b) const {
+    output += "BOARD ";
+    for (gsl::index row = Location::getMaxRowIndex(); row >= 0; --row) {
+        for (gsl::index col = 0; col <= Location::getMaxColumnIndex(); ++col) {
+            const Piece* piece = b.pieceAt(Location{row, col});
+            output += (piece != nullptr ? static_cast<char>(*piece) : '.');
+        }
+    }
+    output += '\n';
+}
+
+void GameViewProtocol::viewPiece(const Piece &piece) const {
+    output += static_cast<char>(piece);
+}
+
+std::string GameViewProtocol::readInput(std::string_view /*message*/) const {
+    throw std::logic_error("GameViewProtocol can't block for input; moves are read by the server");
+}
+
+void GameViewProtocol::displayEndOfGameMessage(Game::GameState gameState) const {
+    output += std::format("END {}\n", Game::gameStateAsString(gameState));
+}
+
+void GameViewProtocol::displayTurn(const Player &player) const {
+    output += (player.getColour() == Piece::Colour::WHITE ? "TURN WHITE\n" : "TURN BLACK\n");
+}
+
+void GameViewProtocol::displayException(const std::exception &e) const {
+    output += std::format("ERROR {}\n", e.what());
+}
+
+void GameViewProtocol::displayInvalidMove(Game::MoveValidity moveValidity) const {
+    output += std::format("ERROR {}\n", Game::moveValidityAsString(moveValidity));
+}
+
+void GameViewProtocol::displayAttackMap(const AttackMap& attackMap) const {
+    output += "ATTACKS ";
+    for (gsl::index squareIndex = 0; squareIndex < Location::getSquareCount(); ++squareIndex) {
+        output += std::format("{:x}{:x}", attackMap.getCount(squareIndex, Piece::Colour::WHITE), attackMap.getCount(squareIndex, Piece::Colour::BLACK));
+    }
+    output += '\n';
+}
+
+/// EVENT LOOP
+
+EventLoop::EventLoop() : epollFd{epoll_create1(EPOLL_CLOEXEC)} {
+    if (epollFd < 0) {
+        throw std::runtime_error(std::format("epoll_create1 failed: {}", std::strerror(errno)));
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (tickerFd >= 0) {
+        close(tickerFd);
+    }
+    close(epollFd);
+}
+
+void EventLoop::watch(int fd) {
+    // edge-triggered: operations always read/write until EAGAIN before waiting again
+    epoll_event event {.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data = {.fd = fd}};
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throw std::runtime_error(std::format("epoll_ctl failed: {}", std::strerror(errno)));
+    }
+    watched[fd] = {};
+}
+
+void EventLoop::unwatch(int fd) noexcept {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    watched.erase(fd);
+}
+
+void EventLoop::interruptRead(int fd) noexcept {
+    const auto it = watched.find(fd);
+    if (it == watched.end() || it->second.reader == nullptr) return;
+    Operation* operation = std::exchange(it->second.reader, nullptr);
+    operation->waiter.resume();
+}
+
+void EventLoop::setTicker(std::chrono::milliseconds interval, std::function<void()> tick) {
+    if (tickerFd < 0) {
+        tickerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        epoll_event event {.events = EPOLLIN, .data = {.fd = tickerFd}};
+        if (tickerFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, tickerFd, &event) < 0) {
+            throw std::runtime_error(std::format("Cannot create ticker: {}", std::strerror(errno)));
+        }
+    }
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(interval);
+    const timespec period {.tv_sec = seconds.count(), .tv_nsec = std::chrono::nanoseconds{interval - seconds}.count()};
+    const itimerspec timerSpec {.it_interval = period, .it_value = period};
+    if (timerfd_settime(tickerFd, 0, &timerSpec, nullptr) < 0) {
+        throw std::runtime_error(std::format("timerfd_settime failed: {}", std::strerror(errno)));
+    }
+    onTick = std::move(tick);
+}
+
+void EventLoop::run() {
+    isStopping = false;
+    std::array<epoll_event, 256> events {};
+    while (!isStopping) {
+        for (const int fd : std::exchange(readRetries, {})) {
+            const auto it = watched.find(fd);
+            if (it == watched.end() || it->second.reader == nullptr || !it->second.reader->tryComplete()) continue;
+            std::exchange(it->second.reader, nullptr)->waiter.resume();
+        }
+
+        const int eventCount = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (eventCount < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::format("epoll_wait failed: {}", std::strerror(errno)));
+        }
+        for (int i = 0; i < eventCount; ++i) {
+            const int fd = events[i].data.fd;
+            const auto flags = events[i].events;
+            if (fd == tickerFd) {
+                std::uint64_t expirations; // ticks missed while busy are made up by the single onTick() call
+                if (read(tickerFd, &expirations, sizeof(expirations)) > 0) {
+                    onTick();
+                }
+                continue;
+            }
+            const bool isError = (flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0;
+
+            // look the fd up again for each waiter: resuming a game may close its socket
+            for (Operation* Watched::* slot : {&Watched::reader, &Watched::writer}) {
+                const bool isReady = isError || (flags & (slot == &Watched::reader ? EPOLLIN : EPOLLOUT)) != 0;
+                const auto it = watched.find(fd);
+                if (!isReady || it == watched.end() || it->second.*slot == nullptr) continue;
+                Operation* operation = it->second.*slot;
+                if (operation->tryComplete()) {
+                    it->second.*slot = nullptr;
+                    operation->waiter.resume();
+                }
+            }
+        }
+    }
+}
+
+/// SOCKET OPERATIONS
+
+/// co_await yields the next line (without '\n'), or std::nullopt once the peer has gone
+class ReadLine : public EventLoop::Operation {
+    static constexpr std::size_t maxLineLength = 64; // longest legitimate line is a move, so anything longer is abuse
+
+    EventLoop& eventLoop;
+    int fd;
+    std::string& buffer;
+    std::optional<std::string> line;
+
+public:
+    ReadLine(EventLoop& eventLoop, int fd, std::string& buffer) : eventLoop{eventLoop}, fd{fd}, buffer{buffer} { }
+
+    bool tryComplete() noexcept override {
+        while (true) {
+            if (const auto newline = buffer.find('\n'); newline != std::string::npos) {
+                line = buffer.substr(0, newline);
+                if (!line->empty() && line->back() == '\r') line->pop_back();
+                buffer.erase(0, newline + 1);
+                return true;
+            }
+            if (buffer.size() > maxLineLength) return true; // line stays std::nullopt
+
+            std::array<char, 512> chunk {};
+            const ssize_t bytesRead = read(fd, chunk.data(), chunk.size());
+            if (bytesRead > 0) {
+                buffer.append(chunk.data(), static_cast<std::size_t>(bytesRead));
+            } else if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return false;
+            } else if (bytesRead < 0 && errno == EINTR) {
+                continue;
+            } else {
+                return true; // EOF or error
+            }
+        }
+    }
+
+    bool await_ready() noexcept { return tryComplete(); }
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter = handle;
+        eventLoop.waitForRead(fd, *this);
+    }
+    std::optional<std::string> await_resume() noexcept { return std::move(line); }
+};
+
+/// co_await yields whether everything was written
+class WriteAll : public EventLoop::Operation {
+    EventLoop& eventLoop;
+    int fd;
+    std::string data;
+    std::size_t written = 0;
+    bool failed = false;
+
+public:
+    WriteAll(EventLoop& eventLoop, int fd, std::string data) : eventLoop{eventLoop}, fd{fd}, data{std::move(data)} { }
+
+    bool tryComplete() noexcept override {
+        while (written < data.size()) {
+            const ssize_t bytesWritten = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+            if (bytesWritten >= 0) {
+                written += static_cast<std::size_t>(bytesWritten);
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return false;
+            } else if (errno != EINTR) {
+                failed = true;
+                return true;
+            }
+        }
+        return true;
+    }
+
+    bool await_ready() noexcept { return tryComplete(); }
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter = handle;
+        eventLoop.waitForWrite(fd, *this);
+    }
+    bool await_resume() const noexcept { return !failed; }
+};
+
+/// co_await yields a connected non-blocking socket. While the process is out of file descriptors (or memory) it waits,
+/// as it does for a connection, rather than failing at once: retrying straight away would never let a game finish
+/// and free one
+class Accept : public EventLoop::Operation {
+    EventLoop& eventLoop;
+    int listeningFd;
+    int fd = -1;
+
+public:
+    Accept(EventLoop& eventLoop, int listeningFd) : eventLoop{eventLoop}, listeningFd{listeningFd} { }
+
+    bool tryComplete() noexcept override {
+        while (true) {
+            fd = accept4(listeningFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) return true;
+            if (errno != EINTR && errno != ECONNABORTED) return false; // ECONNABORTED: that one's gone, try the next
+        }
+    }
+
+    bool await_ready() noexcept { return tryComplete(); }
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter = handle;
+        eventLoop.waitForRead(listeningFd, *this);
+    }
+    [[nodiscard]] int await_resume() const noexcept { return fd; }
+};
+
+/// SERVER TASK
+
+ServerTask::promise_type::~promise_type() {
+    liveTasks.erase(std::coroutine_handle<promise_type>::from_promise(*this).address());
+}
+
+void ServerTask::promise_type::unhandled_exception() noexcept {
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << std::format("Game session ended by exception: {}\n", e.what());
+    } catch (...) {
+        std::cerr << "Game session ended by unknown exception\n";
+    }
+}
+
+/// GAME SERVER
+
+GameServer::GameServer() : sessionView{new GameViewProtocol}, sessions{sessionView} { }
+
+GameServer::~GameServer() {
+    // games are only ended by their players, so keep these ones out of the journal as still live
+    sessions.attachJournal(nullptr);
+
+    // frames still suspended on a socket; destroying one erases it from liveTasks, so work on a copy
+    const auto suspendedTasks = liveTasks;
+    for (void* address : suspendedTasks) {
+        std::coroutine_handle<>::from_address(address).destroy();
+    }
+    for (int fd : listeningFds) {
+        close(fd);
+    }
+}
+
+struct SocketAddress {
+    sockaddr_storage storage {};
+    socklen_t size {0};
+
+    [[nodiscard]] int getFamily() const noexcept { return storage.ss_family; }
+    [[nodiscard]] const sockaddr* get() const noexcept { return reinterpret_cast<const sockaddr*>(&storage); }
+};
+
+// A TCP port on 127.0.0.1 if `address` is all digits, otherwise a Unix socket path. Throws std::invalid_argument if the
+// path is too long
+static SocketAddress toSocketAddress(std::string_view address) {
+    SocketAddress result;
+    const bool isTcp = !address.empty() && std::all_of(address.begin(), address.end(), [](char c) { return std::isdigit(c); });
+    if (isTcp) {
+        sockaddr_in socketAddress {};
+        socketAddress.sin_family = AF_INET;
+        socketAddress.sin_port = htons(static_cast<std::uint16_t>(std::stoi(std::string{address})));
+        socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        std::memcpy(&result.storage, &socketAddress, sizeof(socketAddress));
+        result.size = sizeof(socketAddress);
+    } else {
+        sockaddr_un socketAddress {};
+        socketAddress.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(socketAddress.sun_path)) {
+            throw std::invalid_argument("Unix socket path too long");
+        }
+        std::copy(address.begin(), address.end(), socketAddress.sun_path);
+        std::memcpy(&result.storage, &socketAddress, sizeof(socketAddress));
+        result.size = sizeof(socketAddress);
+    }
+    return result;
+}
+
+void GameServer::listen(std::string_view address) {
+    const SocketAddress socketAddress = toSocketAddress(address);
+    const int fd = socket(socketAddress.getFamily(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::format("socket failed: {}", std::strerror(errno)));
+    }
+
+    if (socketAddress.getFamily() == AF_INET) {
+        const int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    } else {
+        unlink(std::string{address}.c_str());
+    }
+
+    if (bind(fd, socketAddress.get(), socketAddress.size) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        const std::string reason = std::strerror(errno);
+        close(fd);
+        throw std::runtime_error(std::format("Cannot listen on '{}': {}", address, reason));
+    }
+
+    eventLoop.watch(fd);
+    listeningFds.push_back(fd);
+    acceptConnections(fd);
+}
+
+void GameServer::enableJournal(const std::filesystem::path& directory) {
+    sessions.recover(directory);
+    journal = std::make_unique<Journal>(directory);
+    sessions.attachJournal(journal.get());
+}
+
+void GameServer::enableClocks(const TimeControl& newTimeControl) {
+    timeControl = newTimeControl;
+    eventLoop.setTicker(timerWheel.getTickLength(), [this]() { onClockTick(); });
+}
+
+void GameServer::onClockTick() {
+    // only the games whose timers fire are looked at, however many are being timed
+    timerWheel.advance(TimerWheel::Clock::now(), [this](std::uint64_t tag) {
+        const SessionStore::GameId id = SessionStore::fromTimerTag(tag);
+        if (!sessions.contains(id) || !sessions.checkFlagFall(id)) return;
+        if (const auto it = attachedSlots.find(id.slot); it != attachedSlots.end()) {
+            eventLoop.interruptRead(it->second); // the game stops waiting for a move and sends END
+        }
+    });
+}
+
+std::size_t GameServer::countLiveGames() const noexcept {
+    return sessions.size();
+}
+
+ServerTask GameServer::acceptConnections(int listeningFd) {
+    while (true) {
+        const int fd = co_await Accept{eventLoop, listeningFd};
+        eventLoop.watch(fd);
+        runGame(fd); // runs until the game first waits on its socket, then comes back here
+    }
+}
+
+// "<slot>:<generation>", as sent in a GAME line
+static SessionStore::GameId parseGameId(std::string_view str) {
+    SessionStore::GameId id;
+    const char* const end = str.data() + str.size();
+    const auto [slotEnd, slotError] = std::from_chars(str.data(), end, id.slot);
+    if (slotError != std::errc{} || slotEnd == end || *slotEnd != ':') {
+        throw std::invalid_argument("Expected a game id like 3:1");
+    }
+    const auto [generationEnd, generationError] = std::from_chars(slotEnd + 1, end, id.generation);
+    if (generationError != std::errc{} || generationEnd != end) {
+        throw std::invalid_argument("Expected a game id like 3:1");
+    }
+    return id;
+}
+
+ServerTask GameServer::runGame(int fd) {
+    // closes the socket and frees the game however the coroutine ends, including being destroyed while suspended
+    SessionStore::GameId id = sessions.createGame();
+    attachedSlots.emplace(id.slot, fd);
+    const std::unique_ptr<int, std::function<void(int*)>> socketGuard {&fd, [this, &id](int* socket) {
+        eventLoop.unwatch(*socket);
+        close(*socket);
+        attachedSlots.erase(id.slot);
+        sessions.endGame(id);
+        for (const int listeningFd : listeningFds) {
+            eventLoop.retryRead(listeningFd); // in case accepting stopped for want of this descriptor
+        }
+    }};
+
+    if (timeControl.has_value()) {
+        sessions.startClock(id, *timeControl, timerWheel);
+    }
+
+    std::string readBuffer;
+    if (!co_await WriteAll{eventLoop, fd, std::format("GAME {}:{}\n", id.slot, id.generation)}) co_return;
+
+    while (sessions.getGameState(id) == Game::GameState::IN_PROGRESS) {
+        sessions.displayPosition(id);
+        std::string output = sessionView->takeOutput();
+        if (const std::optional<ChessClock>& clock = sessions.getClock(id); clock.has_value()) {
+            const auto now = ChessClock::Clock::now();
+            auto toMilliseconds = [](ChessClock::Clock::duration duration) { return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(); };
+            output += std::format("CLOCK {} {}\n", toMilliseconds(clock->calcRemaining(Piece::Colour::WHITE, now)),
+                                  toMilliseconds(clock->calcRemaining(Piece::Colour::BLACK, now)));
+        }
+        if (!co_await WriteAll{eventLoop, fd, std::move(output)}) co_return;
+        if (sessions.getGameState(id) != Game::GameState::IN_PROGRESS) break; // flag fell while writing
+
+        const std::optional<std::string> line = co_await ReadLine{eventLoop, fd, readBuffer};
+        if (!line.has_value()) {
+            if (sessions.getGameState(id) == Game::GameState::IN_PROGRESS) co_return; // peer gone
+            break; // flag fell while waiting; see onClockTick()
+        }
+
+        try {
+            if (*line == "ATTACKS") {
+                sessions.displayAttackMap(id);
+                continue;
+            }
+            if (line->starts_with("RESUME ")) {
+                const SessionStore::GameId resumed = parseGameId(std::string_view{*line}.substr(7));
+                if (!sessions.contains(resumed) || attachedSlots.contains(resumed.slot)) {
+                    throw std::invalid_argument("No unattached game with that id");
+                }
+                attachedSlots.erase(id.slot);
+                sessions.endGame(id);
+                id = resumed;
+                attachedSlots.emplace(id.slot, fd);
+                continue;
+            }
+            sessions.playTurn(id, Move{*line});
+        }
+        catch (const std::exception& e) {
+            sessionView->displayException(e);
+        }
+    }
+
+    sessions.displayResult(id);
+    co_await WriteAll{eventLoop, fd, sessionView->takeOutput()};
+}
+
+/// TEST CLIENT
+
+int runServerTestClient(std::string_view address) {
+    SocketAddress socketAddress;
+    try {
+        socketAddress = toSocketAddress(address);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << std::format("Cannot connect to '{}': {}\n", address, e.what());
+        return EXIT_FAILURE;
+    }
+
+    const int fd = socket(socketAddress.getFamily(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, socketAddress.get(), socketAddress.size) < 0) {
+        std::cerr << std::format("Cannot connect to '{}': {}\n", address, std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    // print server lines until it wants a move (or the game ends), then send one line from stdin
+    std::string buffer;
+    std::array<char, 512> chunk {};
+    while (true) {
+        const ssize_t bytesRead = read(fd, chunk.data(), chunk.size());
+        if (bytesRead <= 0) break;
+        buffer.append(chunk.data(), static_cast<std::size_t>(bytesRead));
+
+        bool awaitingMove = false;
+        for (auto newline = buffer.find('\n'); newline != std::string::npos; newline = buffer.find('\n')) {
+            const std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            std::cout << line << '\n';
+            awaitingMove = awaitingMove || line.starts_with("TURN");
+        }
+
+        if (awaitingMove) {
+            std::string move;
+            if (!(std::cin >> move)) break;
+            move += '\n';
+            if (send(fd, move.data(), move.size(), MSG_NOSIGNAL) < 0) break;
+        }
+    }
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "GameController.h"
+#include "Journal.h"
+#include "SessionStore.h"
+#include "TimerWheel.h"
+
+/* Server mode: one thread hosts many games. Each game's loop is a coroutine that suspends whenever it waits on its
+ socket; a single epoll loop resumes whichever games have input.
+
+ Protocol (one line each way, over a Unix socket or 127.0.0.1 TCP):
+    client -> server   a move, eg. "E2E4" or "E7E8Q", or "ATTACKS" to ask for the attack map
+                       "RESUME <slot>:<generation>" to take over a game no connection holds (eg. one recovered from
+                       the journal) in place of the new one
+    server -> client   "GAME <slot>:<generation>", once per game, before its first position
+                       "BOARD <64 chars, A8..H8 down to A1..H1, '.' for empty>"
+                       "TURN WHITE" / "TURN BLACK"
+                       "ERROR <reason>"
+                       "END <result>"
+                       "ATTACKS <64 pairs of hex digits (white, black attacker count), A1..H1 up to A8..H8>"
+                       "CLOCK <white ms> <black ms>", after each TURN in a timed game
+ The connection is closed after "END", which in a timed game may come at any point once a flag has fallen. A closed
+ connection ends its game, except when the server itself shuts down.
+*/
+
+/// View that renders to protocol lines in a buffer rather than to a terminal
+class GameViewProtocol : public GameView {
+    mutable std::string output;
+public:
+    void viewBoard(const Board& b) const override;
+    void viewPiece(const Piece& piece) const override;
+
+    [[nodiscard]] std::string readInput(std::string_view message) const override; // Not supported, moves arrive over the socket
+
+    void displayEndOfGameMessage(Game::GameState gameState) const override;
+    void displayTurn(const Player& player) const override;
+
+    void displayException(const std::exception& e) const override;
+    void displayInvalidMove(Game::MoveValidity moveValidity) const override;
+    void displayAttackMap(const AttackMap& attackMap) const override;
+    [[nodiscard]] std::unique_ptr<GameView> clone() const noexcept override {
+        return std::make_unique<GameViewProtocol>(*this);
+    }
+
+    [[nodiscard]] std::string takeOutput() const noexcept { return std::exchange(output, {}); }
+};
+
+class EventLoop {
+public:
+    /// Something waiting on a file descriptor. The loop calls tryComplete() each time the descriptor is ready and
+    /// resumes `waiter` once it returns true, so partial reads/writes never wake the coroutine.
+    struct Operation {
+        std::coroutine_handle<> waiter;
+        virtual bool tryComplete() noexcept = 0;
+    protected:
+        ~Operation() = default;
+    };
+
+private:
+    struct Watched {
+        Operation* reader = nullptr;
+        Operation* writer = nullptr;
+    };
+
+    /// DATA MEMBERS
+    int epollFd;
+    bool isStopping = false;
+    std::unordered_map<int, Watched> watched;
+    int tickerFd = -1;
+    std::function<void()> onTick;
+    std::vector<int> readRetries;
+
+public:
+    /// CONSTRUCTORS / DESTRUCTORS
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /// MISC.
+    void watch(int fd); // fd must be non-blocking
+    void unwatch(int fd) noexcept;
+    void waitForRead(int fd, Operation& operation) noexcept { watched[fd].reader = &operation; }
+    void waitForWrite(int fd, Operation& operation) noexcept { watched[fd].writer = &operation; }
+    // Resumes whatever waits to read `fd` without completing it (eg. a ReadLine then yields std::nullopt)
+    void interruptRead(int fd) noexcept;
+    // Tries whatever waits to read `fd` again on run()'s next turn, for readiness epoll won't report a second time
+    // (eg. an accept that failed for want of file descriptors, once one is closed)
+    void retryRead(int fd) { readRetries.push_back(fd); }
+
+    // Calls `onTick` from run() every `interval`, however busy the sockets are
+    void setTicker(std::chrono::milliseconds interval, std::function<void()> onTick);
+
+    void run();
+    void stop() noexcept { isStopping = true; }
+};
+
+/// Detached coroutine owned by a GameServer; destroyed when it finishes or when the server is destroyed
+struct ServerTask {
+    struct promise_type {
+        std::unordered_set<void*>& liveTasks;
+
+        template <typename... Args>
+        explicit promise_type(class GameServer& server, Args&&...);
+        ~promise_type();
+
+        ServerTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+    };
+};
+
+class GameServer {
+    /// DATA MEMBERS
+    EventLoop eventLoop;
+    GameViewProtocol* sessionView;  // owned by `sessions`
+    SessionStore sessions;          // every game's position; sessions only hold a GameId
+    std::unique_ptr<Journal> journal;
+    std::unordered_map<std::uint32_t, int> attachedSlots; // games some connection is playing -> its socket
+    std::optional<TimeControl> timeControl;               // for new games; untimed if none
+    TimerWheel timerWheel;                                // every timed game's flag fall
+    std::vector<int> listeningFds;
+    std::unordered_set<void*> liveTasks; // coroutine frame addresses
+
+    /// FRIENDS
+    friend struct ServerTask::promise_type;
+
+public:
+    /// CONSTRUCTORS / DESTRUCTORS
+    GameServer();
+    ~GameServer();
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    /// SETUP
+    // `address` is a TCP port on 127.0.0.1 if it's all digits, otherwise a Unix socket path
+    void listen(std::string_view address);
+    // Recovers the games journaled in `directory` by an earlier run, then journals to it. Call before run()
+    void enableJournal(const std::filesystem::path& directory);
+    // Times every game started from now on. A game whose flag falls ends there, even while waiting for a move
+    void enableClocks(const TimeControl& timeControl);
+
+    /// MISC.
+    void run() { eventLoop.run(); }
+    void stop() noexcept { eventLoop.stop(); }
+    [[nodiscard]] std::size_t countLiveGames() const noexcept;
+
+private:
+    ServerTask acceptConnections(int listeningFd);
+    ServerTask runGame(int fd);
+    void onClockTick();
+};
+
+template <typename... Args>
+ServerTask::promise_type::promise_type(GameServer& server, Args&&...) : liveTasks{server.liveTasks} {
+    liveTasks.insert(std::coroutine_handle<promise_type>::from_promise(*this).address());
+}
+
+/// Blocking line-by-line relay between stdin/stdout and a server, for trying the protocol by hand
+int runServerTestClient(std::string_view address);
@@ -4,6 +4,16 @@
 
 #include "GameView.h"
 
+#include <unistd.h>
+
+GameViewCLI::GameViewCLI(bool useAnsi) : useAnsi{useAnsi} {
+    frame.reserve(512); // a full first frame with escape codes is ~200 bytes
+}
+
+bool GameViewCLI::isStdoutTerminal() noexcept {
+    return isatty(STDOUT_FILENO) != 0;
+}
+
 std::string GameViewCLI::readInput(std::string_view message) const {
     std::string input;
     std::cout << message << '\n';
@@ -17,40 +27,76 @@ void GameViewCLI::viewPiece(const Piece& piece) const {
 
 void GameViewCLI::viewBoard(const Board &b) const {
 
-    const auto& board { b.board };
-
-    const gsl::index maxRowIndex { Location::getMaxRowIndex() };
-    const gsl::index maxColumnIndex { Location::getMaxColumnIndex() };
-
-    for (gsl::index row = maxRowIndex; row >= 0; --row) { // top-left to bottom-right
-        for (gsl::index col = 0; col <= maxColumnIndex; ++col) {
-
-            const Location location {row, col};
-
-            if (board.contains(location)) {
-                const gsl::not_null<Piece*> piece = board.at(location).get(); // not_null not strictly necessary here
-                viewPiece(*piece);
-            } else {
-                std::cout << '.';
-            }
-
-            std::cout << ' ';
-            if (location.getBoardColumnIndex() == maxColumnIndex) {
-                std::cout << '\n';
-            }
+    const Board::Mailbox mailbox = b.calcMailbox();
+    std::array<char, Location::getSquareCount()> squares {};
+    for (gsl::index i = 0; i < Location::getSquareCount(); ++i) {
+        squares[i] = (mailbox[i] != nullptr ? static_cast<char>(*mailbox[i]) : '.');
+    }
 
+    frame.clear();
+    if (!useAnsi) {
+        appendFullBoard(squares);
+    }
+    else if (!isBoardShown) {
+        frame += "\x1b[2J\x1b[H"; // clear screen, cursor to top-left
+        appendFullBoard(squares);
+        frame += std::format("\x1b[{};r\x1b[{};1H", boardLineCount + 1, boardLineCount + 1); // messages scroll below the board
+    }
+    else {
+        frame += "\x1b" "7"; // save cursor (split so the 7 isn't read as part of the hex escape)
+        for (gsl::index i = 0; i < Location::getSquareCount(); ++i) {
+            if (squares[i] == shownSquares[i]) continue;
+            const gsl::index line = Location::getMaxRowIndex() - i / (Location::getMaxColumnIndex() + 1) + 1;
+            const gsl::index column = 2 * (i % (Location::getMaxColumnIndex() + 1)) + 1;
+            frame += std::format("\x1b[{};{}H", line, column);
+            frame += squares[i];
         }
+        frame += "\x1b" "8"; // restore cursor
     }
 
-    std::cout << '\n';
+    std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size())).flush();
+    shownSquares = squares;
+    isBoardShown = useAnsi;
+}
 
+void GameViewCLI::appendFullBoard(const std::array<char, Location::getSquareCount()>& squares) const {
+    const gsl::index columnCount = Location::getMaxColumnIndex() + 1;
+    for (gsl::index row = Location::getMaxRowIndex(); row >= 0; --row) { // top-left to bottom-right
+        for (gsl::index col = 0; col < columnCount; ++col) {
+            frame += squares[row * columnCount + col];
+            frame += ' ';
+        }
+        frame += '\n';
+    }
+    frame += '\n';
 }
 
 void GameViewCLI::displayException(const std::exception &e) const {
     std::cout << e.what() << '\n';
 }
 
+void GameViewCLI::displayInvalidMove(const Game::MoveValidity moveValidity) const {
+    std::cout << std::format("ERROR: {}", Game::moveValidityAsString(moveValidity)) << '\n';
+}
+
+void GameViewCLI::displayAttackMap(const AttackMap& attackMap) const {
+    // "white attackers:black attackers" per square, laid out like the board
+    frame.clear();
+    for (gsl::index row = Location::getMaxRowIndex(); row >= 0; --row) {
+        for (gsl::index col = 0; col <= Location::getMaxColumnIndex(); ++col) {
+            const gsl::index squareIndex = row * (Location::getMaxColumnIndex() + 1) + col;
+            frame += std::format("{}:{} ", attackMap.getCount(squareIndex, Piece::Colour::WHITE), attackMap.getCount(squareIndex, Piece::Colour::BLACK));
+        }
+        frame += '\n';
+    }
+    std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size())).flush();
+}
+
 void GameViewCLI::displayEndOfGameMessage(const Game::GameState gameState) const {
+    if (isBoardShown) {
+        std::cout << "\x1b[r"; // hand the whole screen back to the terminal
+        isBoardShown = false;
+    }
     std::cout << std::format("End of Game: {}", Game::gameStateAsString(gameState)) << '\n';
 }
 
@@ -59,34 +105,6 @@ void GameViewCLI::displayTurn(const Player &player) const {
     std::cout << std::format("{}'s turn\n", colourString);
 }
 
-GameViewOpenGL::GameViewOpenGL() {
-
-    if (!glfwInit()) { throw std::runtime_error("Cannot initialise GLFW"); }
-
-    // Set GLFW window hints before creating the window
-
-    window = glfwCreateWindow(640, 480, "Chess", nullptr, nullptr);
-
-    if (!window) {
-        glfwTerminate();
-        throw std::runtime_error("Failed to create GLFW window");
-    }
-
-    glfwMakeContextCurrent(window);
-
-    while (!glfwWindowShouldClose(window)) {
-
-        // Your game rendering logic goes here
-        // Clear the screen, render your chessboard, pieces, and other elements
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();                           // Poll for and process events
-    }
-
-    // Cleanup GLFW and other resources in the destructor
-}
-
-GameViewOpenGL::~GameViewOpenGL() {
-    glfwTerminate(); // Cleanup and terminate GLFW when the object is destroyed
+std::string GameViewNone::readInput(std::string_view /*message*/) const {
+    throw std::logic_error("GameViewNone can't read input; pass moves to GameController::playTurn()");
 }
-
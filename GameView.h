@@ -2,7 +2,7 @@
 
 #include "Board.h"
 #include "Game.h"
-#include "glfw-3.3.8/include/GLFW/glfw3.h"
+#include "Analysis.h"
 
 class GameView {
 public:
@@ -17,11 +17,24 @@ public:
     virtual void displayTurn(const Player& player) const = 0;
 
     virtual void displayException(const std::exception& e) const = 0;
+    virtual void displayInvalidMove(Game::MoveValidity moveValidity) const = 0;
+    virtual void displayAttackMap(const AttackMap& attackMap) const = 0;
     [[nodiscard]] virtual std::unique_ptr<GameView> clone() const noexcept = 0;
 };
 
 class GameViewCLI : public GameView {
+    /* With ANSI escape codes (ie. stdout is a terminal) the board is drawn once at the top of the screen and
+     messages scroll in a region below it. Later calls to viewBoard() only overwrite the squares that changed.
+     Each frame is composed in `frame` and written with one call. */
+    bool useAnsi;
+    mutable bool isBoardShown = false;
+    mutable std::array<char, Location::getSquareCount()> shownSquares {};
+    mutable std::string frame;
+
+    static constexpr int boardLineCount = 9; // 8 ranks + blank line
 public:
+    explicit GameViewCLI(bool useAnsi = isStdoutTerminal());
+
     void viewBoard(const Board &b) const override;
     void viewPiece(const Piece& piece) const override;
 
@@ -31,33 +44,32 @@ public:
     void displayTurn(const Player& player) const override;
 
     void displayException(const std::exception& e) const override;
+    void displayInvalidMove(Game::MoveValidity moveValidity) const override;
+    void displayAttackMap(const AttackMap& attackMap) const override;
     [[nodiscard]] std::unique_ptr<GameView> clone() const noexcept override {
         return std::make_unique<GameViewCLI>(*this);
     }
-};
 
-class GameViewOpenGL : public GameView {
 private:
-    GLFWwindow* window;
-public:
-
-    GameViewOpenGL();
-
-    ~GameViewOpenGL() override;
-
-    void viewBoard(const Board &b) const override {
-        // TODO: Remove code duplication w/ GameViewCLI::viewBoard()
+    [[nodiscard]] static bool isStdoutTerminal() noexcept;
+    void appendFullBoard(const std::array<char, Location::getSquareCount()>& squares) const;
+};
 
-    }
-    void viewPiece(const Piece& piece) const override {}
+// Shows nothing and can't ask for input, for embedding the rules where there's no one to show things to
+class GameViewNone : public GameView {
+public:
+    void viewBoard(const Board& /*b*/) const override {}
+    void viewPiece(const Piece& /*piece*/) const override {}
 
-    [[nodiscard]] std::string readInput(std::string_view message) const override {}
+    [[nodiscard]] std::string readInput(std::string_view message) const override; // Throws std::logic_error
 
-    void displayEndOfGameMessage(Game::GameState gameState) const override {}
-    void displayTurn(const Player& player) const override {}
+    void displayEndOfGameMessage(Game::GameState /*gameState*/) const override {}
+    void displayTurn(const Player& /*player*/) const override {}
 
-    void displayException(const std::exception& e) const override {}
+    void displayException(const std::exception& /*e*/) const override {}
+    void displayInvalidMove(Game::MoveValidity /*moveValidity*/) const override {}
+    void displayAttackMap(const AttackMap& /*attackMap*/) const override {}
     [[nodiscard]] std::unique_ptr<GameView> clone() const noexcept override {
-        return std::make_unique<GameViewOpenGL>(*this);
+        return std::make_unique<GameViewNone>(*this);
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "GameView.h"
+#include "glfw-3.3.8/include/GLFW/glfw3.h"
+
+// Only built into the GUI executable; the rules themselves never need GLFW
+class GameViewOpenGL : public GameView {
+private:
+    GLFWwindow* window;
+public:
+
+    GameViewOpenGL();
+
+    ~GameViewOpenGL() override;
+
+    void viewBoard(const Board &b) const override {
+        // TODO: Remove code duplication w/ GameViewCLI::viewBoard()
+
+    }
+    void viewPiece(const Piece& piece) const override {}
+
+    [[nodiscard]] std::string readInput(std::string_view message) const override {}
+
+    void displayEndOfGameMessage(Game::GameState gameState) const override {}
+    void displayTurn(const Player& player) const override {}
+
+    void displayException(const std::exception& e) const override {}
+    void displayInvalidMove(Game::MoveValidity moveValidity) const override {}
+    void displayAttackMap(const AttackMap& attackMap) const override {}
+    [[nodiscard]] std::unique_ptr<GameView> clone() const noexcept override {
+        return std::make_unique<GameViewOpenGL>(*this);
+    }
+};
\ No newline at end of file
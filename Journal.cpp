@@ -0,0 +1,173 @@
+#include "Journal.h"
+#include "Checksum.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+#include "format"
+
+/// CONSTRUCTORS / DESTRUCTORS
+
+Journal::Journal(std::filesystem::path directory, std::size_t maxSegmentBytes, std::chrono::milliseconds commitInterval)
+        : directory{std::move(directory)}
+        , maxSegmentBytes{maxSegmentBytes}
+        , commitInterval{commitInterval}
+{
+    std::filesystem::create_directories(this->directory);
+
+    std::uint32_t lastSegmentNumber = 0;
+    for (const auto& path : listSegments(this->directory)) {
+        lastSegmentNumber = std::max(lastSegmentNumber, static_cast<std::uint32_t>(std::stoul(path.stem().string().substr(8))));
+    }
+    openSegment(lastSegmentNumber + 1);
+
+    writer = std::jthread{[this] { runWriter(); }};
+}
+
+Journal::~Journal() {
+    {
+        const std::lock_guard lock {mutex};
+        isStopping = true;
+    }
+    writerWakeup.notify_one();
+    writer.join();
+    close(segmentFd);
+}
+
+/// WRITING
+
+std::uint64_t Journal::append(Record record) {
+    record.checksum = calcChecksum(record);
+
+    const std::lock_guard lock {mutex};
+    if (writerError != nullptr) {
+        throw std::runtime_error("Journal writer has failed; records are no longer durable");
+    }
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(&record);
+    pending.insert(pending.end(), bytes, bytes + sizeof(Record));
+    return ++appendedSequence;
+}
+
+void Journal::waitUntilDurable(std::uint64_t sequence) {
+    std::unique_lock lock {mutex};
+    if (durableSequence < sequence) {
+        flushRequested = true; // no point waiting out the commit interval
+        writerWakeup.notify_one();
+    }
+    durableChanged.wait(lock, [&] { return durableSequence >= sequence || writerError != nullptr; });
+    if (writerError != nullptr) {
+        std::rethrow_exception(writerError);
+    }
+}
+
+void Journal::runWriter() {
+    std::vector<std::uint8_t> batch;
+    std::unique_lock lock {mutex};
+    while (true) {
+        writerWakeup.wait_for(lock, commitInterval, [&] { return isStopping || (flushRequested && !pending.empty()); });
+        if (pending.empty()) {
+            if (isStopping) return;
+            continue;
+        }
+
+        // everything appended since the last commit goes out in one write + fdatasync
+        batch.swap(pending);
+        flushRequested = false;
+        const std::uint64_t batchSequence = appendedSequence;
+        lock.unlock();
+        try {
+            writeBatch(batch);
+        }
+        catch (...) {
+            lock.lock();
+            writerError = std::current_exception();
+            durableChanged.notify_all();
+            return;
+        }
+        batch.clear();
+        lock.lock();
+
+        durableSequence = batchSequence;
+        durableChanged.notify_all();
+    }
+}
+
+void Journal::writeBatch(const std::vector<std::uint8_t>& batch) {
+    if (segmentBytes > 0 && segmentBytes + batch.size() > maxSegmentBytes) {
+        close(segmentFd);
+        openSegment(segmentNumber + 1);
+    }
+
+    std::size_t written = 0;
+    while (written < batch.size()) {
+        const ssize_t result = write(segmentFd, batch.data() + written, batch.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::format("Journal write failed: {}", std::strerror(errno)));
+        }
+        written += static_cast<std::size_t>(result);
+    }
+    if (fdatasync(segmentFd) < 0) {
+        throw std::runtime_error(std::format("Journal fdatasync failed: {}", std::strerror(errno)));
+    }
+    segmentBytes += batch.size();
+}
+
+void Journal::openSegment(std::uint32_t number) {
+    const auto path = directory / std::format("segment-{:08}.wal", number);
+    segmentFd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (segmentFd < 0) {
+        throw std::runtime_error(std::format("Cannot create journal segment '{}': {}", path.string(), std::strerror(errno)));
+    }
+    segmentNumber = number;
+    segmentBytes = 0;
+
+    // the new file's directory entry must be durable too, or a crash could lose the whole segment
+    const int directoryFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd >= 0) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+}
+
+/// READING
+
+void Journal::replay(const std::filesystem::path& directory, const std::function<void(const Record&)>& apply) {
+    if (!std::filesystem::exists(directory)) return;
+
+    std::vector<std::uint8_t> contents;
+    for (const auto& path : listSegments(directory)) {
+        std::ifstream file {path, std::ios::binary};
+        contents.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+
+        // a torn or corrupt record is where the run that wrote this segment crashed; the next run started a new one
+        for (std::size_t offset = 0; offset + sizeof(Record) <= contents.size(); offset += sizeof(Record)) {
+            Record record;
+            std::memcpy(&record, contents.data() + offset, sizeof(Record));
+            if (record.checksum != calcChecksum(record)) break;
+            apply(record);
+        }
+    }
+}
+
+/// MISC.
+
+std::vector<std::filesystem::path> Journal::listSegments(const std::filesystem::path& directory) {
+    std::vector<std::filesystem::path> segments;
+    for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with("segment-") && name.ends_with(".wal")) {
+            segments.push_back(entry.path());
+        }
+    }
+    std::sort(segments.begin(), segments.end()); // zero-padded numbers, so name order is log order
+    return segments;
+}
+
+std::uint32_t Journal::calcChecksum(const Record& record) noexcept {
+    return crc32(reinterpret_cast<const std::uint8_t*>(&record), offsetof(Record, checksum));
+}
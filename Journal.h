@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/* Append-only write-ahead log of games, so live games survive a crash (see SessionStore::recover()).
+
+ append() only copies the record into memory; a background thread writes whatever has built up with one write() and
+ one fdatasync() (group commit), so no move waits on the disk. A crash can lose at most the last commit interval.
+ The log is split into numbered segment files of at most `maxSegmentBytes`.
+
+ NB: Segments are never deleted; compacting the log would need position snapshots in it.
+*/
+class Journal {
+public:
+    /// STRUCTS / ENUMS
+    enum class RecordType : std::uint8_t {GAME_CREATED, MOVE, GAME_ENDED};
+
+    struct Record {
+        std::uint32_t gameSlot {0};       // SessionStore::GameId
+        std::uint32_t gameGeneration {0};
+        std::uint64_t positionHash {0};   // Game::calcHash() after the record is applied
+        std::uint16_t move {0};           // Move::getRaw(), for MOVE records
+        RecordType type {RecordType::MOVE};
+        std::uint8_t unused {0};
+        std::uint32_t checksum {0};       // crc32 of the bytes above, set by append(). Catches torn writes
+    };
+    static_assert(sizeof(Record) == 24);
+    static_assert(std::is_trivially_copyable_v<Record>);
+
+    static constexpr std::size_t defaultMaxSegmentBytes = std::size_t{64} << 20;
+
+private:
+    /// DATA MEMBERS
+    const std::filesystem::path directory;
+    const std::size_t maxSegmentBytes;
+    const std::chrono::milliseconds commitInterval;
+
+    std::mutex mutex;
+    std::condition_variable writerWakeup;
+    std::condition_variable durableChanged;
+    std::vector<std::uint8_t> pending;    // appended, not yet handed to the writer
+    std::uint64_t appendedSequence {0};   // records appended so far
+    std::uint64_t durableSequence {0};    // records on disk so far
+    bool isStopping = false;
+    bool flushRequested = false;          // a waitUntilDurable() caller wants `pending` written now
+    std::exception_ptr writerError;
+
+    // only touched by the writer thread (and the constructor, before it starts)
+    int segmentFd {-1};
+    std::uint32_t segmentNumber {0};
+    std::size_t segmentBytes {0};
+
+    std::jthread writer; // last, so it starts after everything above is initialised
+
+public:
+    /// CONSTRUCTORS / DESTRUCTORS
+    // Starts a new segment after any already in `directory` (creating it if needed), never appending to an old one
+    explicit Journal(std::filesystem::path directory,
+                     std::size_t maxSegmentBytes = defaultMaxSegmentBytes,
+                     std::chrono::milliseconds commitInterval = std::chrono::milliseconds{5});
+    ~Journal(); // commits everything appended
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /// WRITING
+    // Returns the record's sequence number. Throws std::runtime_error if the writer has failed
+    std::uint64_t append(Record record);
+    void waitUntilDurable(std::uint64_t sequence); // for callers that must know a record is on disk
+
+    /// READING
+    // Calls `apply` for every record in order. A segment's records end at the first torn or corrupt one (ie. a crash)
+    static void replay(const std::filesystem::path& directory, const std::function<void(const Record&)>& apply);
+
+private:
+    void runWriter();
+    void writeBatch(const std::vector<std::uint8_t>& batch);
+    void openSegment(std::uint32_t number);
+
+    [[nodiscard]] static std::vector<std::filesystem::path> listSegments(const std::filesystem::path& directory);
+    [[nodiscard]] static std::uint32_t calcChecksum(const Record& record) noexcept;
+};
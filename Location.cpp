@@ -19,6 +19,12 @@ bool Location::isForwardMove(const Location &source, const Location &destination
     return destination.boardRowIndex.value() > source.boardRowIndex.value();
 }
 
+bool Location::areCollinear(const Location &a, const Location &b, const Location &c) noexcept {
+    const auto [abRow, abColumn] = Location::calculateRowColumnDifferences(a, b);
+    const auto [acRow, acColumn] = Location::calculateRowColumnDifferences(a, c);
+    return abRow * acColumn == abColumn * acRow;
+}
+
 bool Location::isKnightMove(const Location &source, const Location &destination) noexcept {
     const auto differences = Location::calculateRowColumnDifferences(source, destination);
     return (abs(differences.columnDifference) == 2 && abs(differences.rowDifference) == 1)
@@ -97,6 +103,15 @@ Location::Location(std::string_view str) {
     }
 }
 
+Location Location::fromSquareIndex(gsl::index squareIndex) {
+    const gsl::index rowLength = maxColumnIndex + 1;
+    return Location{squareIndex / rowLength, squareIndex % rowLength};
+}
+
+gsl::index Location::getSquareIndex() const {
+    return boardRowIndex.value() * (maxColumnIndex + 1) + boardColumnIndex.value();
+}
+
 Location::Location(gsl::index row, gsl::index col) : boardRowIndex{row}, boardColumnIndex{col} {
     if (!isValid()) {
         throw std::invalid_argument("Invalid Location");
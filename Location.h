@@ -4,6 +4,7 @@
 
 #include <string>
 #include <compare>
+#include <cstdint>
 #include "format"
 #include <iostream>
 #include "gsl/gsl"
@@ -44,13 +45,17 @@ public:
     Location() = default; // Null location
     Location(gsl::index row, gsl::index col);
     explicit Location(std::string_view str); // Chess notation -> Coordinates (eg. "A2" -> 1,0 )
+    [[nodiscard]] static Location fromSquareIndex(gsl::index squareIndex); // 0 = A1, 1 = B1, ..., 63 = H8
 
     /// GETTERS
 
     [[nodiscard]] static constexpr gsl::index getMaxColumnIndex() noexcept { return maxColumnIndex; }
     [[nodiscard]] static constexpr gsl::index getMaxRowIndex() noexcept { return maxRowIndex; }
+    [[nodiscard]] static constexpr gsl::index getSquareCount() noexcept { return (maxRowIndex + 1) * (maxColumnIndex + 1); }
     [[nodiscard]] auto getBoardRowIndex() const noexcept { return boardRowIndex; }
     [[nodiscard]] auto getBoardColumnIndex() const noexcept { return boardColumnIndex; }
+    [[nodiscard]] gsl::index getSquareIndex() const; // Inverse of fromSquareIndex(). Throws for null locations
+    [[nodiscard]] std::uint64_t getSquareBit() const { return std::uint64_t{1} << getSquareIndex(); } // For 64-bit square sets
 
     /// ... For structured bindings
     template<size_t I>
@@ -82,6 +87,7 @@ public:
     [[nodiscard]] static bool isVertical(const Location& source, const Location& destination) noexcept;
     [[nodiscard]] static bool isKnightMove(const Location& source, const Location& destination) noexcept;
     [[nodiscard]] static bool isForwardMove(const Location& source, const Location& destination) noexcept;
+    [[nodiscard]] static bool areCollinear(const Location& a, const Location& b, const Location& c) noexcept;
     
     /// MISC.
 private:
@@ -0,0 +1,204 @@
+#include "MateSolver.h"
+
+#include <algorithm>
+#include <bit>
+
+/// CONSTRUCTORS
+
+MateSolver::MateSolver(std::size_t tableBytes, std::uint64_t maxNodes) : maxNodes{maxNodes} {
+    const std::size_t entryCount = std::bit_floor(std::max(tableBytes / sizeof(Entry), std::size_t{2}));
+    table = std::make_unique<Entry[]>(entryCount);
+    tableMask = entryCount - 1;
+}
+
+/// SOLVING
+
+MateSolver::Result MateSolver::solve(const GameController& controller, int maxMateIn) {
+    Result result;
+    GameController position {controller};
+    attacker = position.getGame().getActivePlayer().getColour();
+    nodeCount = 0;
+
+    // shortest first, so the first proof found is the shortest mate
+    result.outcome = Outcome::NO_MATE;
+    for (int mateIn = 1; mateIn <= maxMateIn && result.outcome == Outcome::NO_MATE; ++mateIn) {
+        result.outcome = prove(position, mateIn);
+        result.mateIn = mateIn;
+    }
+    if (result.outcome != Outcome::MATE) {
+        result.mateIn = 0;
+        result.nodeCount = nodeCount;
+        return result;
+    }
+
+    // main line: the first attacker move that mates in time, then the reply that holds out longest. If the node limit
+    // cuts this short, the line stops there and uniqueness is unconfirmed
+    result.isUnique = true;
+    for (int movesLeft = result.mateIn; movesLeft > 0; ) {
+        const Game::PackedPosition before = position.getGame().takeSnapshot();
+        std::optional<Move> mating;
+        for (const Move& move : position.calcLegalMoves()) {
+            position.applyMoveUnchecked(move);
+            const Outcome outcome = prove(position, movesLeft - 1);
+            position.restorePosition(before);
+            if (outcome == Outcome::UNKNOWN || (outcome == Outcome::MATE && mating.has_value())) {
+                result.isUnique = false;
+            }
+            if (outcome == Outcome::MATE && !mating.has_value()) {
+                mating = move;
+            }
+        }
+        if (!mating.has_value()) {
+            result.isUnique = false;
+            break;
+        }
+        position.applyMoveUnchecked(*mating);
+        result.line.push_back(*mating);
+
+        const Game::PackedPosition afterMating = position.getGame().takeSnapshot();
+        const MoveList replies = position.calcLegalMoves();
+        if (replies.empty()) break; // mated
+        std::optional<Move> longestReply;
+        int longestMovesLeft = 0;
+        for (const Move& reply : replies) {
+            position.applyMoveUnchecked(reply);
+            const int length = findMateLength(position, movesLeft - 1);
+            position.restorePosition(afterMating);
+            if (length > longestMovesLeft) {
+                longestReply = reply;
+                longestMovesLeft = length;
+            }
+        }
+        if (!longestReply.has_value()) {
+            result.isUnique = false;
+            break;
+        }
+        position.applyMoveUnchecked(*longestReply);
+        result.line.push_back(*longestReply);
+        movesLeft = longestMovesLeft;
+    }
+
+    result.nodeCount = nodeCount;
+    return result;
+}
+
+MateSolver::Outcome MateSolver::prove(GameController& controller, int movesLeft) {
+    const ProofNumbers numbers = search(controller, movesLeft, {infinity, infinity});
+    if (numbers.proof == 0) return Outcome::MATE;
+    if (numbers.disproof == 0) return Outcome::NO_MATE;
+    return Outcome::UNKNOWN;
+}
+
+MateSolver::ProofNumbers MateSolver::search(GameController& controller, int movesLeft, ProofNumbers thresholds) {
+    const Game& game = controller.getGame();
+    const std::uint64_t key = calcKey(game, movesLeft);
+    const ProofNumbers known = probe(key);
+    if (known.proof == 0 || known.disproof == 0) return known;
+
+    ++nodeCount;
+    const bool isAttackerToMove = (game.getActivePlayer().getColour() == attacker);
+    const MoveList moves = controller.calcLegalMoves();
+
+    // leaves
+    if (moves.empty()) {
+        const bool isMate = !isAttackerToMove && controller.isInCheck();
+        store(key, isMate ? proven : disproven);
+        return isMate ? proven : disproven;
+    }
+    if (movesLeft == 0) {
+        store(key, disproven); // the attacker has no moves left to mate with
+        return disproven;
+    }
+
+    // children are only told apart by their table keys, so work those out once
+    const int childMovesLeft = (isAttackerToMove ? movesLeft - 1 : movesLeft);
+    const Game::PackedPosition position = game.takeSnapshot();
+    std::vector<std::uint64_t> childKeys;
+    childKeys.reserve(moves.size());
+    for (const Move& move : moves) {
+        controller.applyMoveUnchecked(move);
+        childKeys.push_back(calcKey(game, childMovesLeft));
+        controller.restorePosition(position);
+    }
+
+    // OR node (attacker): proof = min over children, disproof = sum. AND node (defender): the other way round
+    while (true) {
+        std::uint64_t sum = 0;
+        std::uint32_t best = infinity, secondBest = infinity;
+        std::size_t bestChild = 0;
+        std::uint32_t bestChildSummed = 0; // the best child's contribution to `sum`
+        for (std::size_t i = 0; i < childKeys.size(); ++i) {
+            const ProofNumbers child = probe(childKeys[i]);
+            const std::uint32_t minimised = (isAttackerToMove ? child.proof : child.disproof);
+            const std::uint32_t summed = (isAttackerToMove ? child.disproof : child.proof);
+            sum = std::min<std::uint64_t>(sum + summed, infinity);
+            if (minimised < best) {
+                secondBest = best;
+                best = minimised;
+                bestChild = i;
+                bestChildSummed = summed;
+            } else if (minimised < secondBest) {
+                secondBest = minimised;
+            }
+        }
+        const ProofNumbers numbers = (isAttackerToMove
+                ? ProofNumbers{best, static_cast<std::uint32_t>(sum)}
+                : ProofNumbers{static_cast<std::uint32_t>(sum), best});
+
+        if (numbers.proof >= thresholds.proof || numbers.disproof >= thresholds.disproof || nodeCount >= maxNodes) {
+            store(key, numbers);
+            return numbers;
+        }
+
+        // the most-proving child gets just enough room to overtake the runner-up or exhaust this node's threshold
+        const std::uint32_t minimisedThreshold = std::min<std::uint32_t>(
+                isAttackerToMove ? thresholds.proof : thresholds.disproof,
+                secondBest == infinity ? infinity : secondBest + 1);
+        const std::uint32_t summedThreshold = static_cast<std::uint32_t>(std::min<std::uint64_t>(
+                std::uint64_t{isAttackerToMove ? thresholds.disproof : thresholds.proof} - sum + bestChildSummed, infinity));
+        const ProofNumbers childThresholds = (isAttackerToMove
+                ? ProofNumbers{minimisedThreshold, summedThreshold}
+                : ProofNumbers{summedThreshold, minimisedThreshold});
+
+        controller.applyMoveUnchecked(moves[bestChild]);
+        search(controller, childMovesLeft, childThresholds);
+        controller.restorePosition(position);
+    }
+}
+
+int MateSolver::findMateLength(GameController& controller, int maxMovesLeft) {
+    for (int movesLeft = 1; movesLeft <= maxMovesLeft; ++movesLeft) {
+        if (prove(controller, movesLeft) == Outcome::MATE) return movesLeft;
+    }
+    return 0;
+}
+
+/// TABLE
+
+MateSolver::ProofNumbers MateSolver::probe(std::uint64_t key) const noexcept {
+    // two-way buckets: an entry may be in either slot of its pair
+    const std::size_t index = key & tableMask;
+    for (const std::size_t slot : {index, index ^ 1}) {
+        if (table[slot].key == key) return table[slot].numbers;
+    }
+    return unknown;
+}
+
+void MateSolver::store(std::uint64_t key, ProofNumbers numbers) noexcept {
+    const std::size_t index = key & tableMask;
+    auto isSolved = [&](std::size_t slot) { return table[slot].numbers.proof == 0 || table[slot].numbers.disproof == 0; };
+
+    std::size_t slot = index;
+    if (table[index ^ 1].key == key) {
+        slot = index ^ 1;
+    } else if (table[index].key != key && isSolved(index) && !isSolved(index ^ 1)) {
+        slot = index ^ 1; // solved entries are worth more than ones still being searched
+    }
+    table[slot] = Entry{.key = key, .numbers = numbers};
+}
+
+std::uint64_t MateSolver::calcKey(const Game& game, int movesLeft) const noexcept {
+    // moves left and who's attacking get their own random key, like a piece on a square
+    std::uint64_t state = static_cast<std::uint64_t>(movesLeft) * 2 + (attacker == Piece::Colour::BLACK ? 1 : 0);
+    return game.calcHash() ^ splitMix64(state);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "GameController.h"
+
+/* Forced mate search for the side to move ("mate in N" puzzles), by depth-first proof-number search (df-pn).
+
+ Each node carries a proof number (how many leaves must still be shown to be mate for the attacker to win) and a
+ disproof number (the same for the defender escaping); the search always expands the most-proving node and only
+ backs up when a node's numbers pass the thresholds its parent gave it. Proof and disproof numbers are kept in a
+ fixed-size transposition table, so memory is bounded whatever the search size; an entry that gets replaced is just
+ worked out again.
+
+ Positions are keyed by hash together with the attacker moves left, so the searched graph has no cycles.
+*/
+class MateSolver {
+public:
+    /// STRUCTS / ENUMS
+    enum class Outcome {MATE, NO_MATE, UNKNOWN}; // UNKNOWN = the node limit was hit first
+
+    struct Result {
+        Outcome outcome {Outcome::UNKNOWN};
+        int mateIn {0};                // attacker moves, for MATE
+        std::vector<Move> line;        // attacker move, reply, ..., mating move. Replies put off mate the longest
+        bool isUnique {false};         // each attacker move on `line` is the only one that mates in time (duals rule
+                                       // a puzzle out), as far as the node limit allowed checking
+        std::uint64_t nodeCount {0};
+    };
+
+private:
+    struct ProofNumbers {
+        std::uint32_t proof;
+        std::uint32_t disproof;
+    };
+    struct Entry {
+        std::uint64_t key {0};
+        ProofNumbers numbers {1, 1};
+    };
+
+    static constexpr std::uint32_t infinity = 0x7FFFFFFF;
+    static constexpr ProofNumbers proven {0, infinity};
+    static constexpr ProofNumbers disproven {infinity, 0};
+    static constexpr ProofNumbers unknown {1, 1};
+
+    /// DATA MEMBERS
+    std::unique_ptr<Entry[]> table;
+    std::size_t tableMask;  // entry count - 1
+    std::uint64_t maxNodes;
+    std::uint64_t nodeCount {0};
+    Piece::Colour attacker {Piece::Colour::WHITE};
+
+public:
+    /// CONSTRUCTORS
+    static constexpr std::size_t defaultTableBytes = std::size_t{32} << 20;
+    // `maxNodes` bounds each solve()'s work, so a batch over many positions has a predictable run time
+    explicit MateSolver(std::size_t tableBytes = defaultTableBytes, std::uint64_t maxNodes = 5'000'000);
+
+    /// SOLVING
+    // Shortest forced mate for the side to move in at most `maxMateIn` moves, with its main line
+    [[nodiscard]] Result solve(const GameController& controller, int maxMateIn);
+
+private:
+    // Whether the attacker can force mate with `movesLeft` more moves of theirs. UNKNOWN if the node limit is hit
+    [[nodiscard]] Outcome prove(GameController& controller, int movesLeft);
+    ProofNumbers search(GameController& controller, int movesLeft, ProofNumbers thresholds);
+    // Fewest attacker moves (up to `maxMovesLeft`) to force mate, or 0 if there's none that short (or it's unknown)
+    [[nodiscard]] int findMateLength(GameController& controller, int maxMovesLeft);
+
+    [[nodiscard]] ProofNumbers probe(std::uint64_t key) const noexcept;
+    void store(std::uint64_t key, ProofNumbers numbers) noexcept;
+    [[nodiscard]] std::uint64_t calcKey(const Game& game, int movesLeft) const noexcept;
+};
@@ -0,0 +1,42 @@
+#include "Move.h"
+
+Move::Move(const Location &source, const Location &destination, std::optional<Piece::Type> promotionType)
+        : data{static_cast<std::uint16_t>(source.getSquareIndex()
+                                          | (destination.getSquareIndex() << destinationShift)
+                                          | (promotionType ? (static_cast<int>(*promotionType) + 1) << promotionShift : 0))}
+{ }
+
+Move::Move(std::string_view str) {
+    if (str.size() != 4 && str.size() != 5) {
+        throw std::invalid_argument("Invalid move string. Expected eg. \"E2E4\" or \"E7E8Q\".");
+    }
+    std::optional<Piece::Type> promotionType;
+    if (str.size() == 5) {
+        switch (str[4]) {
+            case 'N': promotionType = Piece::Type::KNIGHT; break;
+            case 'B': promotionType = Piece::Type::BISHOP; break;
+            case 'R': promotionType = Piece::Type::ROOK; break;
+            case 'Q': promotionType = Piece::Type::QUEEN; break;
+            default: throw std::invalid_argument("Invalid promotion piece in move string");
+        }
+    }
+    *this = Move{Location{str.substr(0, 2)}, Location{str.substr(2, 2)}, promotionType};
+}
+
+std::optional<Piece::Type> Move::getPromotionType() const noexcept {
+    const auto promotionBits = (data >> promotionShift) & promotionMask;
+    if (promotionBits == 0) return std::nullopt;
+    return static_cast<Piece::Type>(promotionBits - 1);
+}
+
+Move::operator std::string() const {
+    auto squareName = [](gsl::index squareIndex) {
+        const gsl::index rowLength = Location::getMaxColumnIndex() + 1;
+        return std::format("{}{}", static_cast<char>('A' + squareIndex % rowLength), squareIndex / rowLength + 1);
+    };
+    static constexpr std::array<char, 6> promotionChars {'P', 'N', 'B', 'R', 'Q', 'K'};
+    const auto promotionType = getPromotionType();
+    return squareName(getSourceIndex())
+           + squareName(getDestinationIndex())
+           + (promotionType ? std::string(1, promotionChars[static_cast<std::size_t>(*promotionType)]) : "");
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include "Location.h"
+#include "Piece.h"
+
+class Move {
+
+    /// DATA MEMBERS
+    /* 16 bits, packed as:
+        bits  0-5  : source square index      (see Location::getSquareIndex())
+        bits  6-11 : destination square index
+        bits 12-14 : promotion piece type + 1 (0 = no promotion)
+        bit  15    : unused
+     Promotion colour isn't stored as it's always the mover's colour. */
+    std::uint16_t data {0};
+
+    static constexpr std::uint16_t squareMask = 0x3F;
+    static constexpr int destinationShift = 6;
+    static constexpr int promotionShift = 12;
+    static constexpr std::uint16_t promotionMask = 0x7;
+
+    /// CONSTRUCTORS
+public:
+    Move() = default; // Null move
+    Move(const Location& source, const Location& destination, std::optional<Piece::Type> promotionType = std::nullopt);
+
+    explicit Move(std::string_view str); // Inverse of operator std::string() (eg. "E7E8Q"). Throws std::invalid_argument
+    [[nodiscard]] static constexpr Move fromRaw(std::uint16_t raw) noexcept { Move move; move.data = raw; return move; }
+
+    /// GETTERS
+    [[nodiscard]] constexpr std::uint16_t getRaw() const noexcept { return data; }
+    [[nodiscard]] constexpr gsl::index getSourceIndex() const noexcept { return data & squareMask; }
+    [[nodiscard]] constexpr gsl::index getDestinationIndex() const noexcept { return (data >> destinationShift) & squareMask; }
+    [[nodiscard]] Location getSource() const { return Location::fromSquareIndex(getSourceIndex()); }
+    [[nodiscard]] Location getDestination() const { return Location::fromSquareIndex(getDestinationIndex()); }
+    [[nodiscard]] std::optional<Piece::Type> getPromotionType() const noexcept;
+
+    [[nodiscard]] constexpr bool isNull() const noexcept { return data == 0; } // A1 -> A1 is never a move
+
+    /// OPERATORS
+    explicit operator std::string() const; // eg. "E7E8Q"
+
+    constexpr auto operator<=>(const Move& other) const noexcept = default;
+    constexpr bool operator==(const Move& other) const noexcept = default;
+};
+
+static_assert(sizeof(Move) == 2);
+static_assert(std::is_trivially_copyable_v<Move>);
+
+class MoveList {
+public:
+    // 218 is the most legal moves known in any reachable position. Rounded up for headroom.
+    static constexpr std::size_t capacity = 256;
+
+private:
+    /// DATA MEMBERS
+    std::array<Move, capacity> moves;
+    std::size_t count {0};
+
+public:
+    /// MODIFIERS
+    void push_back(const Move& move) noexcept { moves[count++] = move; }
+    void clear() noexcept { count = 0; }
+
+    /// GETTERS
+    [[nodiscard]] std::size_t size() const noexcept { return count; }
+    [[nodiscard]] bool empty() const noexcept { return count == 0; }
+    [[nodiscard]] const Move& operator[](std::size_t i) const noexcept { return moves[i]; }
+
+    /// ITERATORS
+    [[nodiscard]] auto begin() const noexcept { return moves.cbegin(); }
+    [[nodiscard]] auto end() const noexcept { return moves.cbegin() + static_cast<std::ptrdiff_t>(count); }
+    [[nodiscard]] auto begin() noexcept { return moves.begin(); }
+    [[nodiscard]] auto end() noexcept { return moves.begin() + static_cast<std::ptrdiff_t>(count); }
+
+    /// MISC.
+    [[nodiscard]] bool contains(const Move& move) const noexcept { return std::find(begin(), end(), move) != end(); }
+};
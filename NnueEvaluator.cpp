@@ -0,0 +1,268 @@
+#include "NnueEvaluator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+/// KERNELS
+// Each has an AVX2, an SSE4.1 and a scalar version; which one is compiled is decided by the target flags
+
+static void addRow(std::int16_t* accumulator, const std::int16_t* row, std::size_t size) noexcept {
+#if defined(__AVX2__)
+    for (std::size_t i = 0; i < size; i += 16) {
+        const __m256i sum = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + i)),
+                                             _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulator + i), sum);
+    }
+#elif defined(__SSE4_1__)
+    for (std::size_t i = 0; i < size; i += 8) {
+        const __m128i sum = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator + i)),
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator + i), sum);
+    }
+#else
+    for (std::size_t i = 0; i < size; ++i) {
+        accumulator[i] = static_cast<std::int16_t>(accumulator[i] + row[i]);
+    }
+#endif
+}
+
+static void subtractRow(std::int16_t* accumulator, const std::int16_t* row, std::size_t size) noexcept {
+#if defined(__AVX2__)
+    for (std::size_t i = 0; i < size; i += 16) {
+        const __m256i difference = _mm256_sub_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + i)),
+                                                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulator + i), difference);
+    }
+#elif defined(__SSE4_1__)
+    for (std::size_t i = 0; i < size; i += 8) {
+        const __m128i difference = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator + i)),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator + i), difference);
+    }
+#else
+    for (std::size_t i = 0; i < size; ++i) {
+        accumulator[i] = static_cast<std::int16_t>(accumulator[i] - row[i]);
+    }
+#endif
+}
+
+// int16 -> uint8 clamped to [0, 127]
+static void clippedReluFromAccumulator(const std::int16_t* input, std::uint8_t* output, std::size_t size) noexcept {
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < size; i += 32) {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i + 16));
+        // packs works per 128-bit lane, so undo the lane interleaving afterwards
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0b11011000);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_max_epi8(packed, zero));
+    }
+#elif defined(__SSE4_1__)
+    const __m128i zero = _mm_setzero_si128();
+    for (std::size_t i = 0; i < size; i += 16) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_max_epi8(_mm_packs_epi16(low, high), zero));
+    }
+#else
+    for (std::size_t i = 0; i < size; ++i) {
+        output[i] = static_cast<std::uint8_t>(std::clamp<int>(input[i], 0, 127));
+    }
+#endif
+}
+
+// output[o] = bias[o] + sum_i weights[o][i] * input[i], with `inputSize` a multiple of 32
+static void affineTransform(const std::uint8_t* input,
+                            const std::int8_t* weights,
+                            const std::int32_t* biases,
+                            std::int32_t* output,
+                            std::size_t inputSize,
+                            std::size_t outputSize) noexcept {
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    auto dotProduct = [&](const std::int8_t* row, __m256i input32, __m256i sum) {
+        const __m256i products = _mm256_maddubs_epi16(input32, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row)));
+        return _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    };
+    std::size_t o = 0;
+    for (; o + 4 <= outputSize; o += 4) { // four rows at a time so each input chunk is loaded once
+        const std::int8_t* row = weights + o * inputSize;
+        __m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (std::size_t i = 0; i < inputSize; i += 32) {
+            const __m256i input32 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            sum0 = dotProduct(row + i, input32, sum0);
+            sum1 = dotProduct(row + inputSize + i, input32, sum1);
+            sum2 = dotProduct(row + 2 * inputSize + i, input32, sum2);
+            sum3 = dotProduct(row + 3 * inputSize + i, input32, sum3);
+        }
+        const __m256i sums = _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1), _mm256_hadd_epi32(sum2, sum3));
+        const __m128i totals = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + o),
+                         _mm_add_epi32(totals, _mm_loadu_si128(reinterpret_cast<const __m128i*>(biases + o))));
+    }
+    for (; o < outputSize; ++o) {
+        const std::int8_t* row = weights + o * inputSize;
+        __m256i sum = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < inputSize; i += 32) {
+            sum = dotProduct(row + i, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)), sum);
+        }
+        const __m128i halves = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        const __m128i pairs = _mm_add_epi32(halves, _mm_shuffle_epi32(halves, 0b01001110));
+        const __m128i total = _mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, 0b10110001));
+        output[o] = biases[o] + _mm_cvtsi128_si32(total);
+    }
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16(1);
+    for (std::size_t o = 0; o < outputSize; ++o) {
+        const std::int8_t* row = weights + o * inputSize;
+        __m128i sum = _mm_setzero_si128();
+        for (std::size_t i = 0; i < inputSize; i += 16) {
+            const __m128i products = _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)),
+                                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+        }
+        const __m128i pairs = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0b01001110));
+        const __m128i total = _mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, 0b10110001));
+        output[o] = biases[o] + _mm_cvtsi128_si32(total);
+    }
+#else
+    for (std::size_t o = 0; o < outputSize; ++o) {
+        const std::int8_t* row = weights + o * inputSize;
+        std::int32_t sum = biases[o];
+        for (std::size_t i = 0; i < inputSize; ++i) {
+            sum += static_cast<std::int32_t>(input[i]) * row[i];
+        }
+        output[o] = sum;
+    }
+#endif
+}
+
+// int32 -> uint8, scaled down by the weight scale (64) and clamped to [0, 127]
+static void clippedReluFromLayer(const std::int32_t* input, std::uint8_t* output, std::size_t size) noexcept {
+    constexpr int weightScaleBits = 6;
+    for (std::size_t i = 0; i < size; ++i) {
+        output[i] = static_cast<std::uint8_t>(std::clamp(input[i] >> weightScaleBits, 0, 127));
+    }
+}
+
+/// LOADING
+
+std::shared_ptr<const NnueNetwork> NnueNetwork::loadFromFile(const std::string &path) {
+    std::ifstream file {path, std::ios::binary};
+    if (!file) {
+        throw std::runtime_error(std::format("Cannot open NNUE weights file '{}'", path));
+    }
+
+    std::array<char, 8> magic {};
+    file.read(magic.data(), magic.size());
+    if (!file || std::memcmp(magic.data(), "MCVNNUE1", magic.size()) != 0) {
+        throw std::runtime_error(std::format("'{}' is not an NNUE weights file", path));
+    }
+
+    auto readArray = [&](auto& vector, std::size_t size) {
+        vector.resize(size);
+        file.read(reinterpret_cast<char*>(vector.data()), static_cast<std::streamsize>(size * sizeof(vector[0])));
+    };
+
+    std::shared_ptr<NnueNetwork> network {new NnueNetwork};
+    readArray(network->featureBiases, halfDimensions);
+    readArray(network->featureWeights, inputDimensions * halfDimensions);
+    readArray(network->hidden1Biases, hiddenDimensions);
+    readArray(network->hidden1Weights, hiddenDimensions * hidden1Inputs);
+    readArray(network->hidden2Biases, hiddenDimensions);
+    readArray(network->hidden2Weights, hiddenDimensions * hiddenDimensions);
+    file.read(reinterpret_cast<char*>(&network->outputBias), sizeof(network->outputBias));
+    readArray(network->outputWeights, hiddenDimensions);
+
+    if (!file || file.peek() != std::ifstream::traits_type::eof()) {
+        throw std::runtime_error(std::format("NNUE weights file '{}' has the wrong size for this architecture", path));
+    }
+    return network;
+}
+
+/// ACCUMULATOR
+
+std::size_t NnueNetwork::featureIndex(Piece::Colour perspective, gsl::index kingSquare, const PieceOnSquare& piece) noexcept {
+    // black sees the board mirrored top-to-bottom, so both perspectives share one set of weights
+    auto orient = [&](gsl::index square) {
+        return static_cast<std::size_t>(perspective == Piece::Colour::WHITE ? square : square ^ 56);
+    };
+    const std::size_t pieceKind = 2 * static_cast<std::size_t>(piece.type) + (piece.colour == perspective ? 0 : 1);
+    const auto squareCount = static_cast<std::size_t>(Location::getSquareCount());
+    return (orient(kingSquare) * pieceKinds + pieceKind) * squareCount + orient(piece.squareIndex);
+}
+
+void NnueNetwork::refresh(const Board &board, Piece::Colour perspective, NnueAccumulator &accumulator) const noexcept {
+    auto& values = accumulator.values[static_cast<std::size_t>(perspective)];
+    std::copy(featureBiases.begin(), featureBiases.end(), values.begin());
+
+    const Location kingLocation = board.getKingLocation(perspective); // O(1), the board keeps track of its kings
+    accumulator.isComputed[static_cast<std::size_t>(perspective)] = (kingLocation != Location{});
+    if (kingLocation == Location{}) return;
+    const gsl::index kingSquare = kingLocation.getSquareIndex();
+
+    for (const auto& [location, piece] : board) {
+        if (piece->getType() == Piece::Type::KING) continue;
+        const PieceOnSquare feature {piece->getType(), piece->getColour(), location.getSquareIndex()};
+        addRow(values.data(), &featureWeights[featureIndex(perspective, kingSquare, feature) * halfDimensions], halfDimensions);
+    }
+}
+
+void NnueNetwork::update(const Board &board, const NnueNetwork::DirtyPieces &dirtyPieces, NnueAccumulator &accumulator) const noexcept {
+    for (const Piece::Colour perspective : {Piece::Colour::WHITE, Piece::Colour::BLACK}) {
+        const auto perspectiveIndex = static_cast<std::size_t>(perspective);
+        const Location kingLocation = board.getKingLocation(perspective);
+
+        const bool kingMoved = std::any_of(dirtyPieces.removed.begin(), dirtyPieces.removed.begin() + static_cast<std::ptrdiff_t>(dirtyPieces.removedCount), [&](const auto& piece) {
+            return piece.type == Piece::Type::KING && piece.colour == perspective;
+        });
+        if (kingMoved || !accumulator.isComputed[perspectiveIndex] || kingLocation == Location{}) {
+            refresh(board, perspective, accumulator); // every feature of this perspective is keyed on its king square
+            continue;
+        }
+        const gsl::index kingSquare = kingLocation.getSquareIndex();
+
+        auto& values = accumulator.values[perspectiveIndex];
+        for (std::size_t i = 0; i < dirtyPieces.removedCount; ++i) {
+            if (dirtyPieces.removed[i].type == Piece::Type::KING) continue;
+            subtractRow(values.data(), &featureWeights[featureIndex(perspective, kingSquare, dirtyPieces.removed[i]) * halfDimensions], halfDimensions);
+        }
+        for (std::size_t i = 0; i < dirtyPieces.addedCount; ++i) {
+            if (dirtyPieces.added[i].type == Piece::Type::KING) continue;
+            addRow(values.data(), &featureWeights[featureIndex(perspective, kingSquare, dirtyPieces.added[i]) * halfDimensions], halfDimensions);
+        }
+    }
+}
+
+/// INFERENCE
+
+int NnueNetwork::evaluate(const NnueAccumulator &accumulator, Piece::Colour sideToMove) const noexcept {
+    constexpr int outputScale = 16;
+    const auto us = static_cast<std::size_t>(sideToMove);
+    const auto them = 1 - us;
+
+    alignas(32) std::array<std::uint8_t, hidden1Inputs> transformed {};
+    clippedReluFromAccumulator(accumulator.values[us].data(), transformed.data(), halfDimensions);
+    clippedReluFromAccumulator(accumulator.values[them].data(), transformed.data() + halfDimensions, halfDimensions);
+
+    alignas(32) std::array<std::int32_t, hiddenDimensions> hidden1Output {};
+    alignas(32) std::array<std::uint8_t, hiddenDimensions> hidden1Activated {};
+    affineTransform(transformed.data(), hidden1Weights.data(), hidden1Biases.data(), hidden1Output.data(), hidden1Inputs, hiddenDimensions);
+    clippedReluFromLayer(hidden1Output.data(), hidden1Activated.data(), hiddenDimensions);
+
+    alignas(32) std::array<std::int32_t, hiddenDimensions> hidden2Output {};
+    alignas(32) std::array<std::uint8_t, hiddenDimensions> hidden2Activated {};
+    affineTransform(hidden1Activated.data(), hidden2Weights.data(), hidden2Biases.data(), hidden2Output.data(), hiddenDimensions, hiddenDimensions);
+    clippedReluFromLayer(hidden2Output.data(), hidden2Activated.data(), hiddenDimensions);
+
+    std::int32_t output = 0;
+    affineTransform(hidden2Activated.data(), outputWeights.data(), &outputBias, &output, hiddenDimensions, 1);
+    return output / outputScale;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Board.h"
+
+/* HalfKP-style network ("halfkp_256x2-32-32"):
+
+    feature transformer   40960 -> 256 per perspective (int16), one row per (own king square, piece, piece square)
+    hidden layer 1        512 -> 32  (int8 weights, clipped ReLU)
+    hidden layer 2        32  -> 32  (int8 weights, clipped ReLU)
+    output                32  -> 1
+
+ The feature transformer output (the "accumulator") is kept per `Game` and updated from the squares a move changes,
+ so a full refresh is only needed when a king moves. Inference uses AVX2 or SSE4.1 when compiled for them
+ (eg. `-mavx2`) and plain loops otherwise.
+*/
+
+struct NnueAccumulator {
+    static constexpr std::size_t halfDimensions = 256;
+
+    /// DATA MEMBERS
+    alignas(32) std::array<std::array<std::int16_t, halfDimensions>, 2> values {}; // indexed by perspective colour
+    std::array<bool, 2> isComputed {false, false};
+};
+
+class NnueNetwork {
+public:
+    /// CONSTANTS
+    static constexpr std::size_t halfDimensions = NnueAccumulator::halfDimensions;
+    static constexpr std::size_t pieceKinds = 10; // pawn..queen for each colour; kings are part of the feature's "bucket"
+    static constexpr std::size_t inputDimensions = Location::getSquareCount() * pieceKinds * Location::getSquareCount();
+    static constexpr std::size_t hidden1Inputs = 2 * halfDimensions;
+    static constexpr std::size_t hiddenDimensions = 32;
+
+    /// STRUCTS
+    struct PieceOnSquare {
+        Piece::Type type;
+        Piece::Colour colour;
+        gsl::index squareIndex;
+    };
+    // What a single move changed. At most castling (king + rook each way) or a capturing promotion
+    struct DirtyPieces {
+        std::array<PieceOnSquare, 4> removed;
+        std::size_t removedCount {0};
+        std::array<PieceOnSquare, 4> added;
+        std::size_t addedCount {0};
+    };
+
+private:
+    /// DATA MEMBERS
+    std::vector<std::int16_t> featureBiases;   // [halfDimensions]
+    std::vector<std::int16_t> featureWeights;  // [inputDimensions][halfDimensions]
+    std::vector<std::int32_t> hidden1Biases;   // [hiddenDimensions]
+    std::vector<std::int8_t> hidden1Weights;   // [hiddenDimensions][hidden1Inputs]
+    std::vector<std::int32_t> hidden2Biases;   // [hiddenDimensions]
+    std::vector<std::int8_t> hidden2Weights;   // [hiddenDimensions][hiddenDimensions]
+    std::int32_t outputBias {0};
+    std::vector<std::int8_t> outputWeights;    // [hiddenDimensions]
+
+    /// CONSTRUCTORS
+    NnueNetwork() = default;
+
+public:
+    /* File layout (little-endian, no padding):
+        8 bytes magic "MCVNNUE1", then each array above in declaration order */
+    [[nodiscard]] static std::shared_ptr<const NnueNetwork> loadFromFile(const std::string& path);
+
+    /// ACCUMULATOR
+    void refresh(const Board& board, Piece::Colour perspective, NnueAccumulator& accumulator) const noexcept;
+    void update(const Board& board, const DirtyPieces& dirtyPieces, NnueAccumulator& accumulator) const noexcept; // `board` is post-move
+
+    /// INFERENCE
+    // Centipawns from the point of view of `sideToMove`
+    [[nodiscard]] int evaluate(const NnueAccumulator& accumulator, Piece::Colour sideToMove) const noexcept;
+
+private:
+    [[nodiscard]] static std::size_t featureIndex(Piece::Colour perspective, gsl::index kingSquare, const PieceOnSquare& piece) noexcept;
+};
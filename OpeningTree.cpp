@@ -0,0 +1,172 @@
+#include "OpeningTree.h"
+#include "GameRecord.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include "format"
+
+static constexpr std::array<char, 8> fileMagic {'M', 'C', 'V', 'O', 'P', 'E', 'N', '1'};
+static constexpr std::size_t fileHeaderBytes = sizeof(fileMagic) + sizeof(std::uint64_t);
+
+static bool isEntryBefore(const OpeningTree::Entry& a, const OpeningTree::Entry& b) noexcept {
+    return a.positionHash != b.positionHash ? a.positionHash < b.positionHash : a.move < b.move;
+}
+
+/// OPENING TREE
+
+OpeningTree OpeningTree::build(std::span<const CorpusGame> corpus, int maxPly, unsigned threadCount) {
+    struct Key {
+        std::uint64_t positionHash;
+        std::uint16_t move;
+        bool operator==(const Key& other) const noexcept = default;
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept { return key.positionHash ^ (std::size_t{key.move} * 0x9E3779B97F4A7C15ULL); }
+    };
+    using Counts = std::unordered_map<Key, Entry, KeyHash>;
+
+    // games are handed out in chunks, so threads rarely touch the shared counter
+    constexpr std::size_t chunkSize = 64;
+    std::atomic<std::size_t> nextGame {0};
+    std::atomic<std::size_t> skippedGames {0};
+    threadCount = std::clamp<unsigned>(threadCount, 1, static_cast<unsigned>(std::max<std::size_t>(corpus.size() / chunkSize, 1)));
+    std::vector<Counts> threadCounts(threadCount);
+
+    auto work = [&](unsigned self) {
+        Counts& counts = threadCounts[self];
+        std::vector<Key> keys; // one game's, only counted once the whole opening has decoded
+        for (std::size_t first = nextGame.fetch_add(chunkSize); first < corpus.size(); first = nextGame.fetch_add(chunkSize)) {
+            for (std::size_t i = first; i < std::min(first + chunkSize, corpus.size()); ++i) {
+                const CorpusGame& game = corpus[i];
+                keys.clear();
+                try {
+                    GameRecordDecoder decoder {game.record};
+                    for (int ply = 0; ply < maxPly; ++ply) {
+                        const std::uint64_t positionHash = decoder.getGame().calcHash();
+                        const std::optional<Move> move = decoder.next();
+                        if (!move.has_value()) break;
+                        keys.push_back(Key{positionHash, move->getRaw()});
+                    }
+                }
+                catch (const std::invalid_argument&) {
+                    ++skippedGames;
+                    continue;
+                }
+
+                for (const Key& key : keys) {
+                    Entry& entry = counts[key];
+                    ++entry.games;
+                    entry.whiteWins += (game.result == Game::GameState::WHITE_WIN ? 1 : 0);
+                    entry.blackWins += (game.result == Game::GameState::BLACK_WIN ? 1 : 0);
+                    entry.draws += (game.result == Game::GameState::DRAW || game.result == Game::GameState::STALEMATE ? 1 : 0);
+                }
+            }
+        }
+    };
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            threads.emplace_back(work, i);
+        }
+        work(0);
+    }
+
+    // reduce: every thread's entries into one list, then sum runs of the same key once sorted
+    OpeningTree tree;
+    tree.skippedGames = skippedGames;
+    std::size_t totalEntries = 0;
+    for (const Counts& counts : threadCounts) {
+        totalEntries += counts.size();
+    }
+    tree.entries.reserve(totalEntries);
+    for (Counts& counts : threadCounts) {
+        for (auto& [key, entry] : counts) {
+            entry.positionHash = key.positionHash;
+            entry.move = key.move;
+            tree.entries.push_back(entry);
+        }
+        counts = Counts{}; // free it as we go
+    }
+    std::sort(tree.entries.begin(), tree.entries.end(), isEntryBefore);
+
+    std::size_t merged = 0;
+    for (std::size_t i = 1; i < tree.entries.size(); ++i) {
+        Entry& last = tree.entries[merged];
+        const Entry& entry = tree.entries[i];
+        if (entry.positionHash != last.positionHash || entry.move != last.move) {
+            tree.entries[++merged] = entry;
+            continue;
+        }
+        last.games += entry.games;
+        last.whiteWins += entry.whiteWins;
+        last.draws += entry.draws;
+        last.blackWins += entry.blackWins;
+    }
+    if (!tree.entries.empty()) {
+        tree.entries.resize(merged + 1);
+    }
+    return tree;
+}
+
+void OpeningTree::write(const std::filesystem::path& path) const {
+    std::ofstream file {path, std::ios::binary | std::ios::trunc};
+    const std::uint64_t entryCount = entries.size();
+    file.write(fileMagic.data(), fileMagic.size());
+    file.write(reinterpret_cast<const char*>(&entryCount), sizeof(entryCount));
+    file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+    if (!file.flush()) {
+        throw std::runtime_error(std::format("Cannot write opening table '{}'", path.string()));
+    }
+}
+
+/// OPENING TABLE
+
+OpeningTable::OpeningTable(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(std::format("Cannot open opening table '{}': {}", path.string(), std::strerror(errno)));
+    }
+    struct stat status {};
+    if (fstat(fd, &status) < 0 || static_cast<std::size_t>(status.st_size) < fileHeaderBytes) {
+        close(fd);
+        throw std::runtime_error(std::format("'{}' isn't an opening table", path.string()));
+    }
+    mappingBytes = static_cast<std::size_t>(status.st_size);
+    void* const address = mmap(nullptr, mappingBytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (address == MAP_FAILED) {
+        throw std::runtime_error(std::format("Cannot map opening table '{}': {}", path.string(), std::strerror(errno)));
+    }
+    mapping = address;
+
+    const auto* bytes = static_cast<const std::uint8_t*>(mapping);
+    std::uint64_t entryCount;
+    std::memcpy(&entryCount, bytes + sizeof(fileMagic), sizeof(entryCount));
+    if (std::memcmp(bytes, fileMagic.data(), fileMagic.size()) != 0
+        || entryCount != (mappingBytes - fileHeaderBytes) / sizeof(OpeningTree::Entry)
+        || (mappingBytes - fileHeaderBytes) % sizeof(OpeningTree::Entry) != 0) {
+        munmap(const_cast<void*>(mapping), mappingBytes);
+        throw std::runtime_error(std::format("'{}' isn't an opening table", path.string()));
+    }
+    entries = {reinterpret_cast<const OpeningTree::Entry*>(bytes + fileHeaderBytes), entryCount};
+}
+
+OpeningTable::~OpeningTable() {
+    munmap(const_cast<void*>(mapping), mappingBytes);
+}
+
+std::span<const OpeningTree::Entry> OpeningTable::lookup(std::uint64_t positionHash) const noexcept {
+    const auto first = std::partition_point(entries.begin(), entries.end(), [&](const auto& entry) { return entry.positionHash < positionHash; });
+    const auto last = std::partition_point(first, entries.end(), [&](const auto& entry) { return entry.positionHash == positionHash; });
+    return {first, last};
+}
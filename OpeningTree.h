@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+#include "Game.h"
+#include "Move.h"
+
+/* Opening explorer: for every position in the first plies of a corpus of games, how often each move was played and
+ how those games ended.
+
+ OpeningTree::build() replays the corpus (game records, see GameRecord.h) over a pool of threads, each counting into
+ its own hash map keyed by position hash and move, then merges the maps into one table sorted by that key. write()
+ saves the table as-is, and OpeningTable maps the file back in, so a lookup is a binary search with no loading step.
+
+ File layout: "MCVOPEN1", entry count (u64), then the entries. Native byte order.
+*/
+
+/// A game in the corpus
+struct CorpusGame {
+    std::vector<std::uint8_t> record; // see encodeGameRecord()
+    Game::GameState result {Game::GameState::IN_PROGRESS}; // IN_PROGRESS if unknown
+};
+
+class OpeningTree {
+public:
+    /// STRUCTS
+    // One move from one position
+    struct Entry {
+        std::uint64_t positionHash {0}; // Game::calcHash() before the move
+        std::uint16_t move {0};         // Move::getRaw()
+        std::uint16_t unused {0};
+        std::uint32_t games {0};
+        std::uint32_t whiteWins {0};
+        std::uint32_t draws {0};        // incl. stalemates; games - whiteWins - draws - blackWins had no known result
+        std::uint32_t blackWins {0};
+        std::uint32_t reserved {0};
+
+        [[nodiscard]] Move getMove() const noexcept { return Move::fromRaw(move); }
+    };
+    static_assert(sizeof(Entry) == 32);
+    static_assert(std::is_trivially_copyable_v<Entry>);
+
+private:
+    /// DATA MEMBERS
+    std::vector<Entry> entries; // sorted by (positionHash, move)
+    std::size_t skippedGames {0};
+
+public:
+    /// CONSTRUCTORS
+    // Counts the first `maxPly` plies of every game. Corrupt records are skipped (see getSkippedGameCount())
+    [[nodiscard]] static OpeningTree build(std::span<const CorpusGame> corpus, int maxPly, unsigned threadCount);
+
+    /// GETTERS
+    [[nodiscard]] std::span<const Entry> getEntries() const noexcept { return entries; }
+    [[nodiscard]] std::size_t getSkippedGameCount() const noexcept { return skippedGames; }
+
+    /// MISC.
+    void write(const std::filesystem::path& path) const; // Throws std::runtime_error
+};
+
+/// Read-only view of a file written by OpeningTree::write(), memory-mapped
+class OpeningTable {
+    /// DATA MEMBERS
+    const void* mapping {nullptr};
+    std::size_t mappingBytes {0};
+    std::span<const OpeningTree::Entry> entries;
+
+public:
+    /// CONSTRUCTORS / DESTRUCTORS
+    explicit OpeningTable(const std::filesystem::path& path); // Throws std::runtime_error if it's not a valid table
+    ~OpeningTable();
+    OpeningTable(const OpeningTable&) = delete;
+    OpeningTable& operator=(const OpeningTable&) = delete;
+
+    /// LOOKUP
+    // Every move played from the position, by move
+    [[nodiscard]] std::span<const OpeningTree::Entry> lookup(std::uint64_t positionHash) const noexcept;
+    [[nodiscard]] std::span<const OpeningTree::Entry> lookup(const Game& game) const noexcept { return lookup(game.calcHash()); }
+    [[nodiscard]] std::size_t size() const noexcept { return entries.size(); }
+};
@@ -0,0 +1,200 @@
+#include "Perft.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <string_view>
+
+struct PerftReference {
+    std::string_view fen;
+    int depth;
+    std::uint64_t nodes;
+};
+
+// From the Chess Programming Wiki's "Perft Results" page (positions 2 to 6), at depths that take seconds
+static constexpr std::array<PerftReference, 5> references {{
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97'862},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 4, 43'238},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9'467},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62'379},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89'890},
+}};
+
+/// CONSTRUCTORS
+
+Perft::Perft(std::size_t tableBytes) {
+    const std::size_t entryCount = std::bit_floor(std::max(tableBytes / sizeof(Entry), std::size_t{1}));
+    table = std::make_unique<Entry[]>(entryCount);
+    tableMask = entryCount - 1;
+}
+
+/// COUNTING
+
+Perft::Result Perft::run(const GameController& controller, int depth, unsigned threadCount) {
+    Result result;
+    if (depth <= 0) {
+        result.nodes = 1;
+        return result;
+    }
+
+    GameController root {controller};
+    const Game::PackedPosition rootPosition = root.getGame().takeSnapshot();
+    const MoveList rootMoves = root.calcLegalMoves();
+    if (depth == 1) {
+        for (const Move& move : rootMoves) {
+            result.divide.emplace_back(move, 1);
+        }
+        result.nodes = rootMoves.size();
+        return result;
+    }
+
+    // Split at the second ply; at depth 2 each task is just counting a reply's moves, so split at the first
+    const int splitPly = (depth >= 3 ? 2 : 1);
+    std::vector<Task> tasks;
+    for (std::size_t i = 0; i < rootMoves.size(); ++i) {
+        root.restorePosition(rootPosition);
+        root.applyMoveUnchecked(rootMoves[i]);
+        if (splitPly == 1) {
+            tasks.push_back(Task{.position = root.getGame().takeSnapshot(), .rootMoveIndex = i});
+            continue;
+        }
+        const Game::PackedPosition replyPosition = root.getGame().takeSnapshot();
+        for (const Move& reply : root.calcLegalMoves()) {
+            root.restorePosition(replyPosition);
+            root.applyMoveUnchecked(reply);
+            tasks.push_back(Task{.position = root.getGame().takeSnapshot(), .rootMoveIndex = i});
+        }
+    }
+
+    threadCount = std::clamp<unsigned>(threadCount, 1, static_cast<unsigned>(std::max<std::size_t>(tasks.size(), 1)));
+    std::vector<WorkQueue> queues(threadCount);
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % threadCount].tasks.push_back(tasks[i]);
+    }
+    std::vector<std::atomic<std::uint64_t>> rootMoveNodes(rootMoves.size());
+
+    // Each thread works from the back of its own queue, then steals from the front of the others'. No task adds
+    // more, so once every queue is empty the run is over
+    auto work = [&](unsigned self) {
+        GameController worker {controller};
+        auto takeTask = [&]() -> std::optional<Task> {
+            for (unsigned offset = 0; offset < threadCount; ++offset) {
+                WorkQueue& queue = queues[(self + offset) % threadCount];
+                const std::lock_guard lock {queue.mutex};
+                if (queue.tasks.empty()) continue;
+                Task task;
+                if (offset == 0) {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                } else {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+                return task;
+            }
+            return std::nullopt;
+        };
+
+        while (const std::optional<Task> task = takeTask()) {
+            worker.restorePosition(task->position);
+            rootMoveNodes[task->rootMoveIndex] += countNodes(worker, depth - splitPly);
+        }
+    };
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            threads.emplace_back(work, i);
+        }
+        work(0);
+    }
+
+    for (std::size_t i = 0; i < rootMoves.size(); ++i) {
+        result.divide.emplace_back(rootMoves[i], rootMoveNodes[i].load());
+        result.nodes += rootMoveNodes[i];
+    }
+    return result;
+}
+
+std::uint64_t Perft::countSerial(const GameController& controller, int depth) {
+    GameController copy {controller};
+    return countNodesUncached(copy, depth);
+}
+
+std::vector<std::string> Perft::selfCheck(unsigned threadCount) {
+    std::vector<std::string> failures;
+    for (const PerftReference& reference : references) {
+        GameController controller {new GameViewNone};
+        controller.setupFromFen(reference.fen);
+        const std::uint64_t nodes = run(controller, reference.depth, threadCount).nodes;
+        if (nodes != reference.nodes) {
+            failures.push_back(std::format("{} depth {}: {} nodes, expected {}", reference.fen, reference.depth, nodes, reference.nodes));
+        }
+    }
+    return failures;
+}
+
+void Perft::clear() noexcept {
+    for (std::size_t i = 0; i <= tableMask; ++i) {
+        table[i].check.store(0, std::memory_order_relaxed);
+        table[i].nodes.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t Perft::countNodes(GameController& controller, int depth) noexcept {
+    if (depth <= 0) return 1;
+
+    const MoveList moves = controller.calcLegalMoves();
+    if (depth == 1) return moves.size(); // no need to make the moves just to count them
+
+    const std::uint64_t key = calcKey(controller.getGame(), depth);
+    if (const std::optional<std::uint64_t> cached = probe(key)) {
+        return *cached;
+    }
+
+    const Game::PackedPosition position = controller.getGame().takeSnapshot();
+    std::uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        controller.applyMoveUnchecked(move);
+        nodes += countNodes(controller, depth - 1);
+        controller.restorePosition(position);
+    }
+    store(key, nodes);
+    return nodes;
+}
+
+std::uint64_t Perft::countNodesUncached(GameController& controller, int depth) noexcept {
+    if (depth <= 0) return 1;
+
+    const MoveList moves = controller.calcLegalMoves();
+    if (depth == 1) return moves.size();
+
+    const Game::PackedPosition position = controller.getGame().takeSnapshot();
+    std::uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        controller.applyMoveUnchecked(move);
+        nodes += countNodesUncached(controller, depth - 1);
+        controller.restorePosition(position);
+    }
+    return nodes;
+}
+
+/// TABLE
+
+std::optional<std::uint64_t> Perft::probe(std::uint64_t key) const noexcept {
+    const Entry& entry = table[key & tableMask];
+    const std::uint64_t nodes = entry.nodes.load(std::memory_order_relaxed);
+    if ((entry.check.load(std::memory_order_relaxed) ^ nodes) != key) return std::nullopt;
+    return nodes;
+}
+
+void Perft::store(std::uint64_t key, std::uint64_t nodes) noexcept {
+    Entry& entry = table[key & tableMask]; // always replace; deeper entries aren't worth more to perft
+    entry.check.store(key ^ nodes, std::memory_order_relaxed);
+    entry.nodes.store(nodes, std::memory_order_relaxed);
+}
+
+std::uint64_t Perft::calcKey(const Game& game, int depth) noexcept {
+    // the depth gets its own random key, so the same position at another depth lands elsewhere
+    std::uint64_t depthState = static_cast<std::uint64_t>(depth);
+    return game.calcHash() ^ splitMix64(depthState);
+}
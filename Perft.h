@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "GameController.h"
+
+/* Move path enumeration ("perft"): the number of leaf positions `depth` plies below a position. Comparing the counts
+ with published ones is the acceptance test for a rules change.
+
+ run() splits the tree into one task per second-ply position and shares them out over a work-stealing pool. Subtree
+ counts are memoised in a table keyed by position hash and depth that all threads share, so transpositions are only
+ counted once. Counts are the same as countSerial()'s, which uses neither.
+
+ NB: Perft follows the rules only, so it carries on past positions GameController would call drawn (eg. insufficient
+ material).
+*/
+class Perft {
+public:
+    /// STRUCTS
+    struct Result {
+        std::uint64_t nodes {0};
+        std::vector<std::pair<Move, std::uint64_t>> divide; // nodes under each root move, in generation order
+    };
+
+private:
+    // Subtree below a second-ply position (or a root move, if the search is too shallow to go further)
+    struct Task {
+        Game::PackedPosition position;
+        std::size_t rootMoveIndex;
+    };
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    // Lockless: `check` is the key XOR the count, so an entry torn by two threads writing at once just misses
+    struct Entry {
+        std::atomic<std::uint64_t> check {0};
+        std::atomic<std::uint64_t> nodes {0};
+    };
+
+    /// DATA MEMBERS
+    std::unique_ptr<Entry[]> table;
+    std::size_t tableMask; // entry count - 1
+
+public:
+    /// CONSTRUCTORS
+    static constexpr std::size_t defaultTableBytes = std::size_t{64} << 20;
+    explicit Perft(std::size_t tableBytes = defaultTableBytes); // rounded down to a power of two entries
+
+    /// COUNTING
+    // Kept between runs, so repeated runs (eg. depth 1..n) reuse each other's subtrees
+    [[nodiscard]] Result run(const GameController& controller, int depth, unsigned threadCount = std::thread::hardware_concurrency());
+    [[nodiscard]] static std::uint64_t countSerial(const GameController& controller, int depth); // the reference
+    // Runs a few published positions chosen for castling, en passant, promotions and pins. One line per wrong count
+    [[nodiscard]] std::vector<std::string> selfCheck(unsigned threadCount = std::thread::hardware_concurrency());
+    void clear() noexcept;
+
+private:
+    [[nodiscard]] std::uint64_t countNodes(GameController& controller, int depth) noexcept;
+    [[nodiscard]] static std::uint64_t countNodesUncached(GameController& controller, int depth) noexcept;
+
+    [[nodiscard]] std::optional<std::uint64_t> probe(std::uint64_t key) const noexcept;
+    void store(std::uint64_t key, std::uint64_t nodes) noexcept;
+    [[nodiscard]] static std::uint64_t calcKey(const Game& game, int depth) noexcept;
+};
@@ -6,6 +6,18 @@ Piece::Piece(Piece::Colour colour) : colour{colour} {}
 
 Piece::Colour Piece::getColour() const noexcept {return colour; }
 
+std::unique_ptr<Piece> Piece::create(Piece::Type type, Piece::Colour colour) noexcept {
+    switch (type) {
+        case Type::PAWN: return std::make_unique<Pawn>(colour);
+        case Type::KNIGHT: return std::make_unique<Knight>(colour);
+        case Type::BISHOP: return std::make_unique<Bishop>(colour);
+        case Type::ROOK: return std::make_unique<Rook>(colour);
+        case Type::QUEEN: return std::make_unique<Queen>(colour);
+        case Type::KING: return std::make_unique<King>(colour);
+    }
+    return nullptr;
+}
+
 /// PAWN
 
 Pawn::Pawn(Piece::Colour colour) : Piece(colour) { }
@@ -20,7 +32,7 @@ bool Pawn::isValidMovePath(const Location &source,
                            const Location &enPassantTargetSquare,
                            const bool isCapture) const noexcept
 {
-    const bool isMoveForward = (getColour() == Piece::Colour::WHITE);
+    const bool isMoveForward = Location::isForwardMove(source, destination); // i.e. towards black's back row
     const bool isMovingInRightDirection = (isMoveForward == (getColour() == Piece::Colour::WHITE));
 
     if (source == destination || !isMovingInRightDirection) return false;
@@ -48,8 +60,9 @@ bool Pawn::isValidMovePath(const Location &source,
     }
 
     // Location::isDiagonal(source, destination)) == true
+    if (abs(deltaRow) != 1) return false;
     const bool isEnPassant = (enPassantTargetSquare == Location{source.getBoardRowIndex().value(), destination.getBoardColumnIndex().value()});
-    return isEnPassant || (isCapture && abs(deltaRow) == 1);
+    return isEnPassant || isCapture;
 }
 
 std::unique_ptr<Piece> Pawn::clone() const noexcept {
@@ -2,6 +2,8 @@
 
 #include <stdexcept>
 #include <locale>
+#include <cstdint>
+#include <memory>
 #include "Location.h"
 
 // NB: Included derived Piece classes here to speed up build-time on the *incredibly* slow machine I'm currently using
@@ -9,6 +11,7 @@ class Piece {
     /// ENUMS / STRUCTS
 public:
     enum class Colour {WHITE, BLACK};
+    enum class Type : std::uint8_t {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
     /// DATA MEMBERS
 protected:
     Colour colour;
@@ -19,6 +22,7 @@ public:
 
     /// GETTERS
     [[nodiscard]] Colour getColour() const noexcept;
+    [[nodiscard]] virtual Type getType() const noexcept = 0;
 
     /// OPERATORS
     [[nodiscard]] virtual explicit operator char() const noexcept = 0;
@@ -31,6 +35,7 @@ public:
 
     /// MISC.
     [[nodiscard]] virtual std::unique_ptr<Piece> clone() const noexcept = 0;
+    [[nodiscard]] static std::unique_ptr<Piece> create(Type type, Colour colour) noexcept;
 };
 
 class Pawn : public Piece {
@@ -38,6 +43,9 @@ public:
     /// CONSTRUCTOR
     explicit Pawn(Colour colour);
 
+    /// GETTERS
+    [[nodiscard]] Type getType() const noexcept override { return Type::PAWN; }
+
     /// OPERATORS
     [[nodiscard]] explicit operator char() const noexcept override;
 
@@ -57,6 +65,9 @@ public:
     /// CONSTRUCTOR
     explicit Bishop(Colour colour);
 
+    /// GETTERS
+    [[nodiscard]] Type getType() const noexcept override { return Type::BISHOP; }
+
     /// OPERATORS
     [[nodiscard]] explicit operator char() const noexcept override;
     /// VALIDATION
@@ -75,6 +86,9 @@ public:
     /// CONSTRUCTOR
     explicit Knight(Colour colour);
 
+    /// GETTERS
+    [[nodiscard]] Type getType() const noexcept override { return Type::KNIGHT; }
+
     /// OPERATORS
     [[nodiscard]] explicit operator char() const noexcept override;
     /// VALIDATION
@@ -92,6 +106,9 @@ public:
     /// CONSTRUCTOR
     explicit Rook(Colour colour);
 
+    /// GETTERS
+    [[nodiscard]] Type getType() const noexcept override { return Type::ROOK; }
+
     /// OPERATORS
     [[nodiscard]] explicit operator char() const noexcept override;
     /// VALIDATION
@@ -110,6 +127,9 @@ public:
     /// CONSTRUCTOR
     explicit Queen(Colour colour);
 
+    /// GETTERS
+    [[nodiscard]] Type getType() const noexcept override { return Type::QUEEN; }
+
     /// OPERATORS
     [[nodiscard]] explicit operator char() const noexcept override;
     /// VALIDATION
@@ -127,6 +147,9 @@ public:
     /// CONSTRUCTOR
     explicit King(Colour colour);
 
+    /// GETTERS
+    [[nodiscard]] Type getType() const noexcept override { return Type::KING; }
+
     /// OPERATORS
     [[nodiscard]] explicit operator char() const noexcept override;
     /// VALIDATION
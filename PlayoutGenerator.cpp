@@ -0,0 +1,92 @@
+#include "PlayoutGenerator.h"
+#include "GameRecord.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+/// GENERATION
+
+PlayoutGenerator::Stats PlayoutGenerator::generate(const Settings& settings, const Sink& sink) {
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> nextGame {0};
+    std::atomic<std::size_t> totalPlies {0};
+    std::mutex sinkMutex;
+
+    auto work = [&]() {
+        std::vector<std::uint32_t> cumulativeWeights;
+        for (std::size_t gameIndex = nextGame++; gameIndex < settings.gameCount; gameIndex = nextGame++) {
+            std::uint64_t gameSeed = settings.seed ^ (gameIndex * 0x9E3779B97F4A7C15ULL);
+            std::uint64_t random = splitMix64(gameSeed); // a different stream per game
+
+            GameRecordEncoder encoder;
+            std::size_t plies = 0;
+            while (encoder.getGame().getGameState() == Game::GameState::IN_PROGRESS && plies < settings.maxPlies) {
+                const MoveList& moves = encoder.getLegalMoves();
+                const std::uint64_t roll = splitMix64(random);
+
+                std::size_t chosen = roll % moves.size();
+                if (settings.moveWeight) {
+                    cumulativeWeights.clear();
+                    std::uint32_t total = 0;
+                    for (const Move& move : moves) {
+                        total += settings.moveWeight(encoder.getGame(), move);
+                        cumulativeWeights.push_back(total);
+                    }
+                    if (total > 0) {
+                        const auto target = static_cast<std::uint32_t>(roll % total);
+                        chosen = static_cast<std::size_t>(std::upper_bound(cumulativeWeights.begin(), cumulativeWeights.end(), target) - cumulativeWeights.begin());
+                    }
+                }
+
+                encoder.add(moves[chosen]);
+                ++plies;
+            }
+
+            const Game::GameState result = encoder.getGame().getGameState();
+            const std::vector<std::uint8_t> record = encoder.finish();
+            totalPlies += plies;
+            const std::lock_guard lock {sinkMutex};
+            sink(gameIndex, record, result);
+        }
+    };
+
+    const unsigned threadCount = std::clamp<unsigned>(settings.threadCount, 1, static_cast<unsigned>(std::max<std::size_t>(settings.gameCount, 1)));
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            threads.emplace_back(work);
+        }
+        work();
+    }
+
+    return Stats{
+        .games = settings.gameCount,
+        .plies = totalPlies,
+        .seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+    };
+}
+
+PlayoutGenerator::Stats PlayoutGenerator::generate(const Settings& settings, std::ostream& out) {
+    return generate(settings, [&out](std::size_t, std::span<const std::uint8_t> record, Game::GameState result) {
+        char header[11];
+        std::size_t headerLength = 0;
+        for (std::size_t length = record.size(); ; length >>= 7) {
+            header[headerLength++] = static_cast<char>((length & 0x7F) | (length > 0x7F ? 0x80 : 0));
+            if (length <= 0x7F) break;
+        }
+        header[headerLength++] = static_cast<char>(result);
+        out.write(header, static_cast<std::streamsize>(headerLength));
+        out.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(record.size()));
+    });
+}
+
+/// WEIGHTINGS
+
+std::uint32_t PlayoutGenerator::preferCaptures(const Game& game, const Move& move) noexcept {
+    const bool isCapture = game.getBoard().pieceAt(move.getDestination()) != nullptr;
+    return (isCapture || move.getPromotionType().has_value() ? 4 : 1);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <span>
+#include <thread>
+#include "Game.h"
+#include "Move.h"
+
+/* Random legal games for load testing, played to the end (or a ply limit) over all cores and handed out as game
+ records (see GameRecord.h).
+
+ Game i is played from its own seed derived from (seed, i), so the same settings always produce the same games,
+ however many threads there are and whichever order they finish in.
+*/
+class PlayoutGenerator {
+public:
+    /// STRUCTS
+    // Relative chance of playing `move`; 0 = never, unless every move is 0. Called from every thread at once
+    using MoveWeight = std::function<std::uint32_t(const Game& game, const Move& move)>;
+
+    struct Settings {
+        std::uint64_t seed {0};
+        std::size_t gameCount {0};
+        std::size_t maxPlies {400};  // games still going after this many plies end IN_PROGRESS
+        unsigned threadCount {std::thread::hardware_concurrency()};
+        MoveWeight moveWeight;       // uniform if empty
+    };
+
+    // Called once per game, one call at a time, in the order games finish. Mustn't throw
+    using Sink = std::function<void(std::size_t gameIndex, std::span<const std::uint8_t> record, Game::GameState result)>;
+
+    struct Stats {
+        std::size_t games {0};
+        std::size_t plies {0};
+        double seconds {0};
+
+        [[nodiscard]] double calcGamesPerSecond() const noexcept { return seconds > 0 ? static_cast<double>(games) / seconds : 0; }
+    };
+
+    /// GENERATION
+    static Stats generate(const Settings& settings, const Sink& sink);
+
+    /* generate() straight to a stream, one game after another as:
+        record length (LEB128 varint), result (Game::GameState, 1 byte), record */
+    static Stats generate(const Settings& settings, std::ostream& out);
+
+    /// WEIGHTINGS
+    // Captures and promotions 4x as likely as quiet moves, which gives games nearer to real ones in length
+    [[nodiscard]] static std::uint32_t preferCaptures(const Game& game, const Move& move) noexcept;
+};
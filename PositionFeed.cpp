@@ -0,0 +1,129 @@
+#include "PositionFeed.h"
+
+#include <algorithm>
+#include <bit>
+
+using Squares = std::array<std::uint8_t, 64>; // a PackedPosition's nibble per square, 0 = empty
+
+static Squares unpack(const Game::PackedPosition& position) noexcept {
+    Squares squares {};
+    int slot = 0;
+    for (std::uint64_t occupied = position.occupancy; occupied != 0 && slot < 32; occupied &= occupied - 1, ++slot) {
+        squares[std::countr_zero(occupied)] = (position.pieces[slot / 2] >> (4 * (slot % 2))) & 0xF;
+    }
+    return squares;
+}
+
+static void pack(const Squares& squares, Game::PackedPosition& position) noexcept {
+    position.occupancy = 0;
+    position.pieces = {};
+    int slot = 0;
+    for (std::size_t square = 0; square < squares.size() && slot < 32; ++square) {
+        if (squares[square] == 0) continue;
+        position.occupancy |= std::uint64_t{1} << square;
+        position.pieces[slot / 2] |= static_cast<std::uint8_t>(squares[square] << (4 * (slot % 2)));
+        ++slot;
+    }
+}
+
+/// SUBSCRIPTION
+
+PositionFeed::Subscription::Subscription(const PositionFeed& feed, std::size_t capacity) : feed{feed} {
+    const std::size_t ringCapacity = std::bit_ceil(std::max(capacity, std::size_t{2}));
+    ring = std::make_unique<Delta[]>(ringCapacity);
+    ringMask = ringCapacity - 1;
+}
+
+std::optional<PositionFeed::Update> PositionFeed::Subscription::poll() {
+    if (needsSnapshot.load(std::memory_order_acquire)) {
+        // the publisher stops writing once it has set the flag, so the ring is ours to empty. The snapshot is read
+        // after the flag is cleared, so it covers every delta that wasn't written; deltas it covers are skipped below
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+        needsSnapshot.store(false, std::memory_order_release);
+
+        Update update;
+        {
+            const std::lock_guard lock {feed.latestMutex};
+            update.snapshot = feed.latest;
+            update.delta.sequence = feed.sequence;
+        }
+        lastSequence = update.delta.sequence;
+        return update;
+    }
+
+    for (std::size_t next = tail.load(std::memory_order_relaxed); next != head.load(std::memory_order_acquire); ) {
+        const Delta delta = ring[next & ringMask];
+        tail.store(++next, std::memory_order_release);
+        if (delta.sequence <= lastSequence) continue;
+        lastSequence = delta.sequence;
+        return Update{.snapshot = std::nullopt, .delta = delta};
+    }
+    return std::nullopt;
+}
+
+/// SUBSCRIBING
+
+std::shared_ptr<PositionFeed::Subscription> PositionFeed::subscribe(std::size_t capacity) {
+    auto subscription = std::make_shared<Subscription>(*this, capacity);
+    const std::lock_guard lock {subscriptionsMutex};
+    subscriptions.push_back(subscription);
+    return subscription;
+}
+
+std::size_t PositionFeed::countSubscriptions() {
+    const std::lock_guard lock {subscriptionsMutex};
+    return static_cast<std::size_t>(std::count_if(subscriptions.begin(), subscriptions.end(), [](const auto& subscription) {
+        return subscription.use_count() > 1;
+    }));
+}
+
+/// PUBLISHING
+
+void PositionFeed::publish(const Game::PackedPosition& after) {
+    Delta delta;
+    bool isDeltaComplete = true; // false if more squares changed than a delta holds, eg. after undoing several moves
+    {
+        const std::lock_guard lock {latestMutex};
+        const Squares before = unpack(latest);
+        const Squares now = unpack(after);
+        for (std::size_t square = 0; square < now.size(); ++square) {
+            if (before[square] == now[square]) continue;
+            if (delta.changeCount == delta.changes.size()) {
+                isDeltaComplete = false;
+                break;
+            }
+            delta.changes[delta.changeCount++] = SquareChange{.square = static_cast<std::uint8_t>(square), .piece = now[square]};
+        }
+        delta.flags = after.flags;
+        delta.enPassantSquare = after.enPassantSquare;
+        delta.sequence = ++sequence;
+        latest = after;
+    }
+
+    const std::lock_guard lock {subscriptionsMutex};
+    std::erase_if(subscriptions, [](const auto& subscription) { return subscription.use_count() == 1; });
+    for (const auto& subscription : subscriptions) {
+        if (subscription->needsSnapshot.load(std::memory_order_acquire)) continue; // it will catch up from `latest`
+
+        const std::size_t next = subscription->head.load(std::memory_order_relaxed);
+        const bool isFull = (next - subscription->tail.load(std::memory_order_acquire) > subscription->ringMask);
+        if (!isDeltaComplete || isFull) {
+            subscription->needsSnapshot.store(true, std::memory_order_release);
+            continue;
+        }
+        subscription->ring[next & subscription->ringMask] = delta;
+        subscription->head.store(next + 1, std::memory_order_release);
+    }
+}
+
+/// APPLYING
+
+void PositionFeed::applyDelta(Game::PackedPosition& position, const Delta& delta) noexcept {
+    Squares squares = unpack(position);
+    for (std::size_t i = 0; i < delta.changeCount; ++i) {
+        squares[delta.changes[i].square] = delta.changes[i].piece;
+    }
+    pack(squares, position);
+    position.flags = delta.flags;
+    position.enPassantSquare = delta.enPassantSquare;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "Game.h"
+
+/* Pushes one game's position to any number of spectators as small per-move deltas instead of whole boards.
+
+ Each subscription has its own bounded ring of deltas, written by the publishing thread and read by whichever thread
+ serves that spectator, without locks. A spectator starts with a full snapshot, then gets deltas; one that falls so
+ far behind that its ring fills is sent a snapshot again rather than holding up the game or anyone else. So is
+ everyone when more squares change than a delta holds (eg. several moves undone at once).
+
+ The feed must outlive its subscriptions.
+*/
+class PositionFeed {
+public:
+    /// STRUCTS
+    struct SquareChange {
+        std::uint8_t square; // see Location::getSquareIndex()
+        std::uint8_t piece;  // as in Game::PackedPosition: (Piece::Type + 1) | (8 if black), 0 = now empty
+    };
+
+    // What one move (or a flag falling) changed. At most 4 squares change: castling moves a king and a rook
+    struct Delta {
+        std::uint32_t sequence {0};            // 1 for the first update published, 2 for the next, ...
+        std::array<SquareChange, 4> changes {};
+        std::uint8_t changeCount {0};
+        std::uint8_t flags {0};                // Game::PackedPosition::flags after the move (side to move, castling, state)
+        std::uint8_t enPassantSquare {Game::PackedPosition::noSquare};
+        std::uint8_t reserved {0};
+    };
+    static_assert(sizeof(Delta) == 16);
+
+    struct Update {
+        std::optional<Game::PackedPosition> snapshot; // the whole position, as of delta.sequence, if this is a snapshot
+        Delta delta;                                  // otherwise what changed
+    };
+
+    class Subscription {
+        /// DATA MEMBERS
+        std::unique_ptr<Delta[]> ring;
+        std::size_t ringMask;                           // capacity - 1
+        alignas(64) std::atomic<std::size_t> head {0};  // next slot to write; only the publisher moves it
+        alignas(64) std::atomic<std::size_t> tail {0};  // next slot to read; only the spectator moves it
+        std::atomic<bool> needsSnapshot {true};         // joined, or the ring filled up; the publisher stops writing
+        std::uint32_t lastSequence {0};                 // spectator's side only
+        const PositionFeed& feed;
+
+        friend class PositionFeed;
+
+    public:
+        Subscription(const PositionFeed& feed, std::size_t capacity);
+
+        // The spectator's next update, or std::nullopt if it's up to date. Call from one thread at a time
+        [[nodiscard]] std::optional<Update> poll();
+    };
+
+private:
+    /// DATA MEMBERS
+    mutable std::mutex latestMutex;
+    Game::PackedPosition latest;   // for snapshots
+    std::uint32_t sequence {0};
+
+    std::mutex subscriptionsMutex;
+    std::vector<std::shared_ptr<Subscription>> subscriptions; // dropped once the spectator lets go of its pointer
+
+public:
+    /// CONSTRUCTORS
+    explicit PositionFeed(const Game::PackedPosition& position) : latest{position} { }
+
+    /// SUBSCRIBING
+    // `capacity` deltas are kept for the spectator (rounded up to a power of two). Any thread
+    [[nodiscard]] std::shared_ptr<Subscription> subscribe(std::size_t capacity = 64);
+    [[nodiscard]] std::size_t countSubscriptions();
+
+    /// PUBLISHING
+    // `after` is the position now; the delta is found by comparing it with the last one published. One thread only
+    void publish(const Game::PackedPosition& after);
+
+    /// APPLYING
+    // Brings a spectator's copy of the position up to date
+    static void applyDelta(Game::PackedPosition& position, const Delta& delta) noexcept;
+};
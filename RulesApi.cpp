@@ -0,0 +1,84 @@
+#include "RulesApi.h"
+#include "GameController.h"
+
+#include <cctype>
+#include <new>
+#include <optional>
+
+struct McvGame {
+    GameController controller {new GameViewNone};
+};
+
+static_assert(MCV_MOVE_VALID == static_cast<int>(Game::MoveValidity::VALID));
+static_assert(MCV_MOVE_OUT_OF_TIME == static_cast<int>(Game::MoveValidity::OUT_OF_TIME));
+static_assert(MCV_GAME_IN_PROGRESS == static_cast<int>(Game::GameState::IN_PROGRESS));
+static_assert(MCV_GAME_BLACK_WIN == static_cast<int>(Game::GameState::BLACK_WIN));
+
+static std::optional<Move> parseMove(const char* move) noexcept {
+    if (move == nullptr) return std::nullopt;
+    try {
+        std::string upper {move};
+        for (char& c : upper) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        return Move{upper};
+    }
+    catch (const std::exception&) { // std::invalid_argument or std::bad_alloc
+        return std::nullopt;
+    }
+}
+
+/// LIFETIME
+
+McvGame* mcv_game_create(void) {
+    try {
+        auto* game = new McvGame;
+        game->controller.setup();
+        return game;
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+McvGame* mcv_game_create_from_fen(const char* fen) {
+    if (fen == nullptr) return nullptr;
+    McvGame* game = nullptr;
+    try {
+        game = new McvGame;
+        game->controller.setupFromFen(fen);
+        return game;
+    }
+    catch (const std::exception&) { // std::invalid_argument or std::bad_alloc
+        delete game;
+        return nullptr;
+    }
+}
+
+void mcv_game_destroy(McvGame* game) {
+    delete game;
+}
+
+/// MOVES
+
+McvMoveValidity mcv_game_validate_move(const McvGame* game, const char* move) {
+    const std::optional<Move> parsed = parseMove(move);
+    if (!parsed.has_value()) return MCV_MOVE_MALFORMED;
+    return static_cast<McvMoveValidity>(game->controller.validateMove(*parsed));
+}
+
+McvMoveValidity mcv_game_apply_move(McvGame* game, const char* move) {
+    const std::optional<Move> parsed = parseMove(move);
+    if (!parsed.has_value()) return MCV_MOVE_MALFORMED;
+    return static_cast<McvMoveValidity>(game->controller.playTurn(*parsed));
+}
+
+/// STATE
+
+McvGameState mcv_game_get_state(const McvGame* game) {
+    return static_cast<McvGameState>(game->controller.getGameState());
+}
+
+int mcv_game_is_black_to_move(const McvGame* game) {
+    return game->controller.getGame().getActivePlayer().getColour() == Piece::Colour::BLACK ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/* Flat C interface to the rules core, for embedding in services (and other languages) without the views.
+
+ A game is an opaque handle owned by the caller: make one with mcv_game_create() or mcv_game_create_from_fen() and
+ release it with mcv_game_destroy(). Moves are strings in either case, eg. "e2e4" or "E7E8Q". No function throws or
+ prints; handles may be used from any thread, but not from two at once.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct McvGame McvGame;
+
+/// Mirror Game::MoveValidity
+enum McvMoveValidity {
+    MCV_MOVE_MALFORMED = -1, /* not a move string */
+    MCV_MOVE_VALID = 0,
+    MCV_MOVE_NO_PIECE_AT_SOURCE,
+    MCV_MOVE_MOVING_WRONG_COLOUR,
+    MCV_MOVE_CAPTURING_OWN_PIECE,
+    MCV_MOVE_INVALID_MOVE_PATH,
+    MCV_MOVE_PATH_BLOCKED,
+    MCV_MOVE_INVALID_CASTLING,
+    MCV_MOVE_INVALID_PROMOTION_PIECE,
+    MCV_MOVE_UNEXPECTED_PROMOTION_PIECE,
+    MCV_MOVE_LEAVES_MOVER_IN_CHECK,
+    MCV_MOVE_OUT_OF_TIME /* only for timed games, which the C interface doesn't make */
+};
+
+/// Mirror Game::GameState
+enum McvGameState {
+    MCV_GAME_IN_PROGRESS = 0,
+    MCV_GAME_DRAW,
+    MCV_GAME_STALEMATE,
+    MCV_GAME_WHITE_WIN,
+    MCV_GAME_BLACK_WIN
+};
+
+/// LIFETIME
+McvGame* mcv_game_create(void);                      /* the starting position. NULL if out of memory */
+McvGame* mcv_game_create_from_fen(const char* fen);  /* NULL if `fen` isn't a usable position */
+void mcv_game_destroy(McvGame* game);                /* NULL is ignored */
+
+/// MOVES
+enum McvMoveValidity mcv_game_validate_move(const McvGame* game, const char* move);
+enum McvMoveValidity mcv_game_apply_move(McvGame* game, const char* move); /* only a valid move is made */
+
+/// STATE
+enum McvGameState mcv_game_get_state(const McvGame* game);
+int mcv_game_is_black_to_move(const McvGame* game);
+
+#ifdef __cplusplus
+}
+#endif
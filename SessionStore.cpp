@@ -0,0 +1,214 @@
+#include "SessionStore.h"
+
+#include <stdexcept>
+#include <utility>
+
+/// GAMES
+
+SessionStore::GameId SessionStore::createGame() {
+    std::uint32_t slot;
+    if (freeSlots.empty()) {
+        slot = static_cast<std::uint32_t>(records.size());
+        records.emplace_back();
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+
+    Record& record = records[slot];
+    const std::uint32_t generation = record.generation + 1; // even -> odd
+    record.position = getStartingPosition();
+    record.generation = generation;
+    ++liveGameCount;
+
+    const GameId id {.slot = slot, .generation = generation};
+    appendToJournal(id, Journal::RecordType::GAME_CREATED, getStartingPositionHash());
+    return id;
+}
+
+void SessionStore::endGame(const GameId& id) {
+    Record& record = recordOf(id);
+    if (id.slot < clocks.size() && clocks[id.slot].has_value()) {
+        clocks[id.slot]->stop();
+        clocks[id.slot].reset();
+    }
+    ++record.generation; // odd -> even, so `id` stops matching
+    freeSlots.push_back(id.slot);
+    --liveGameCount;
+    appendToJournal(id, Journal::RecordType::GAME_ENDED, 0);
+}
+
+bool SessionStore::contains(const GameId& id) const noexcept {
+    return id.slot < records.size() && records[id.slot].generation == id.generation && (id.generation % 2) == 1;
+}
+
+Game::MoveValidity SessionStore::playTurn(const GameId& id, const Move& move) {
+    load(id);
+    const Game::MoveValidity validity = scratch.playTurn(move);
+    if (validity == Game::MoveValidity::VALID) {
+        store(id);
+        appendToJournal(id, Journal::RecordType::MOVE, scratch.getGame().calcHash(), move); // not waited on; see Journal
+    } else if (validity == Game::MoveValidity::OUT_OF_TIME) {
+        store(id); // the game has just ended
+    }
+    return validity;
+}
+
+void SessionStore::displayPosition(const GameId& id) {
+    load(id);
+    scratch.displayPosition();
+}
+
+void SessionStore::displayResult(const GameId& id) {
+    load(id);
+    scratch.displayResult();
+}
+
+void SessionStore::displayAttackMap(const GameId& id) {
+    load(id);
+    scratch.displayAttackMap();
+}
+
+Game::GameState SessionStore::getGameState(const GameId& id) const {
+    return recordOf(id).position.getGameState();
+}
+
+Game SessionStore::materialise(const GameId& id) const {
+    Game game;
+    game.restoreSnapshot(recordOf(id).position);
+    return game;
+}
+
+/// CLOCKS
+
+void SessionStore::startClock(const GameId& id, const TimeControl& timeControl, TimerWheel& wheel) {
+    load(id);
+    scratch.startClock(timeControl, &wheel, toTimerTag(id));
+    store(id);
+}
+
+bool SessionStore::checkFlagFall(const GameId& id) {
+    load(id);
+    const bool hasFlagFallen = scratch.checkFlagFall();
+    if (hasFlagFallen) {
+        store(id);
+    }
+    return hasFlagFallen;
+}
+
+const std::optional<ChessClock>& SessionStore::getClock(const GameId& id) const {
+    static const std::optional<ChessClock> untimed;
+    if (!contains(id)) {
+        throw std::invalid_argument("No live game with that id"); // as recordOf() does for the other accessors
+    }
+    return (id.slot < clocks.size() ? clocks[id.slot] : untimed);
+}
+
+std::size_t SessionStore::calcBytesPerGame() const noexcept {
+    if (liveGameCount == 0) return 0;
+    const std::size_t poolBytes = records.capacity() * sizeof(Record) + clocks.capacity() * sizeof(std::optional<ChessClock>)
+            + freeSlots.capacity() * sizeof(std::uint32_t);
+    return poolBytes / liveGameCount;
+}
+
+/// DURABILITY
+
+void SessionStore::recover(const std::filesystem::path& directory) {
+    if (!records.empty()) {
+        throw std::logic_error("Can only recover into an empty SessionStore");
+    }
+
+    Journal::replay(directory, [this](const Journal::Record& entry) {
+        const GameId id {.slot = entry.gameSlot, .generation = entry.gameGeneration};
+        switch (entry.type) {
+            case Journal::RecordType::GAME_CREATED:
+                if (id.slot >= records.size()) {
+                    records.resize(id.slot + 1);
+                }
+                if (records[id.slot].generation + 1 != id.generation || (id.generation % 2) == 0) {
+                    throw std::runtime_error("Journal creates a game in a slot that's still in use");
+                }
+                records[id.slot] = Record{.position = getStartingPosition(), .generation = id.generation};
+                ++liveGameCount;
+                break;
+            case Journal::RecordType::MOVE:
+                load(id);
+                if (scratch.playTurn(Move::fromRaw(entry.move)) != Game::MoveValidity::VALID
+                    || scratch.getGame().calcHash() != entry.positionHash) {
+                    throw std::runtime_error("Journal doesn't replay to the position it recorded");
+                }
+                store(id);
+                break;
+            case Journal::RecordType::GAME_ENDED:
+                ++recordOf(id).generation;
+                --liveGameCount;
+                break;
+            default:
+                throw std::runtime_error("Unknown journal record type");
+        }
+    });
+
+    for (std::uint32_t slot = 0; slot < records.size(); ++slot) {
+        if ((records[slot].generation % 2) == 0) {
+            freeSlots.push_back(slot);
+        }
+    }
+}
+
+/// MISC.
+
+const SessionStore::Record& SessionStore::recordOf(const GameId& id) const {
+    if (!contains(id)) {
+        throw std::invalid_argument("No live game with that id");
+    }
+    return records[id.slot];
+}
+
+SessionStore::Record& SessionStore::recordOf(const GameId& id) {
+    return const_cast<Record&>(std::as_const(*this).recordOf(id));
+}
+
+void SessionStore::load(const GameId& id) {
+    const std::optional<ChessClock> clock = (id.slot < clocks.size() ? clocks[id.slot] : std::nullopt);
+    scratch.restorePosition(recordOf(id).position, clock); // also drops the previous game's history
+}
+
+void SessionStore::store(const GameId& id) {
+    records[id.slot].position = scratch.getGame().takeSnapshot();
+    const std::optional<ChessClock>& clock = scratch.getGame().getClock();
+    if (clock.has_value() && id.slot >= clocks.size()) {
+        clocks.resize(id.slot + 1);
+    }
+    if (id.slot < clocks.size()) {
+        clocks[id.slot] = clock;
+    }
+}
+
+void SessionStore::appendToJournal(const GameId& id, Journal::RecordType type, std::uint64_t positionHash, const Move& move) {
+    if (journal == nullptr) return;
+    journal->append(Journal::Record{
+        .gameSlot = id.slot,
+        .gameGeneration = id.generation,
+        .positionHash = positionHash,
+        .move = move.getRaw(),
+        .type = type,
+    });
+}
+
+const Game::PackedPosition& SessionStore::getStartingPosition() {
+    static const Game::PackedPosition startingPosition = [] {
+        GameController controller;
+        controller.setup();
+        return controller.getGame().takeSnapshot();
+    }();
+    return startingPosition;
+}
+
+std::uint64_t SessionStore::getStartingPositionHash() {
+    static const std::uint64_t startingPositionHash = [] {
+        Game game;
+        game.restoreSnapshot(getStartingPosition());
+        return game.calcHash();
+    }();
+    return startingPositionHash;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "GameController.h"
+#include "Journal.h"
+
+/* Live games kept as fixed-size records in one contiguous pool rather than as a GameController each (a std::map node
+ and a heap Piece per occupied square, plus a GameView). A single scratch GameController is loaded from a record only
+ while one of its moves is processed or displayed, then written back.
+
+ With a Journal attached, every game created, move accepted and game ended is also appended to it, and recover()
+ rebuilds the live games from it after a restart.
+
+ NB: The evaluator accumulator isn't part of a record; attach a network to a materialised Game if it's needed.
+*/
+class SessionStore {
+public:
+    /// STRUCTS
+    // Slot in the pool plus the generation the slot had when the game was created, so stale ids are caught
+    struct GameId {
+        std::uint32_t slot {0};
+        std::uint32_t generation {0};
+
+        bool operator==(const GameId& other) const noexcept = default;
+    };
+
+    struct Record {
+        Game::PackedPosition position;
+        std::uint32_t generation {0}; // odd while the slot holds a live game
+    };
+    static_assert(sizeof(Record) == 40);
+
+private:
+    /// DATA MEMBERS
+    std::vector<Record> records;
+    std::vector<std::optional<ChessClock>> clocks; // by slot, kept apart as most games are untimed; only as long as needed
+    std::vector<std::uint32_t> freeSlots;
+    std::size_t liveGameCount {0};
+    GameController scratch; // the one materialised game
+    Journal* journal {nullptr};
+
+public:
+    /// CONSTRUCTORS
+    SessionStore() = default; // Moves and messages are displayed by a GameViewCLI
+    explicit SessionStore(gsl::not_null<GameView*> gameView) : scratch{gameView} { }
+
+    /// GAMES
+    [[nodiscard]] GameId createGame(); // standard starting position
+    void endGame(const GameId& id);
+    [[nodiscard]] bool contains(const GameId& id) const noexcept;
+
+    // All of these throw std::invalid_argument if `id` isn't a live game
+    Game::MoveValidity playTurn(const GameId& id, const Move& move); // see GameController::playTurn()
+    void displayPosition(const GameId& id);
+    void displayResult(const GameId& id);
+    void displayAttackMap(const GameId& id);
+    [[nodiscard]] Game::GameState getGameState(const GameId& id) const;
+    [[nodiscard]] Game materialise(const GameId& id) const;
+
+    /// CLOCKS
+    // Times the game from now. Its flag fall is reported to `wheel`'s owner under toTimerTag(id)
+    void startClock(const GameId& id, const TimeControl& timeControl, TimerWheel& wheel);
+    bool checkFlagFall(const GameId& id); // see GameController::checkFlagFall()
+    [[nodiscard]] const std::optional<ChessClock>& getClock(const GameId& id) const;
+
+    [[nodiscard]] static std::uint64_t toTimerTag(const GameId& id) noexcept { return (std::uint64_t{id.slot} << 32) | id.generation; }
+    [[nodiscard]] static GameId fromTimerTag(std::uint64_t tag) noexcept {
+        return GameId{.slot = static_cast<std::uint32_t>(tag >> 32), .generation = static_cast<std::uint32_t>(tag)};
+    }
+
+    /// DURABILITY
+    void attachJournal(Journal* journal) noexcept { this->journal = journal; } // not owned; nullptr detaches
+    /* Replays the journal in `directory` onto this (empty) store, checking every position against the hash recorded
+     with it. Ids handed out before the restart stay valid. Nothing is appended while replaying, so the same directory
+     can then be attached. Throws std::runtime_error if the log doesn't replay to the recorded positions. */
+    void recover(const std::filesystem::path& directory);
+
+    /// MEMORY
+    [[nodiscard]] std::size_t size() const noexcept { return liveGameCount; }
+    void reserve(std::size_t gameCount) { records.reserve(gameCount); }
+    [[nodiscard]] std::size_t calcBytesPerGame() const noexcept; // pool capacity (incl. free slots) over live games
+
+private:
+    [[nodiscard]] const Record& recordOf(const GameId& id) const;
+    [[nodiscard]] Record& recordOf(const GameId& id);
+    void load(const GameId& id);  // into `scratch`
+    void store(const GameId& id); // from `scratch`
+    void appendToJournal(const GameId& id, Journal::RecordType type, std::uint64_t positionHash, const Move& move = {});
+
+    [[nodiscard]] static const Game::PackedPosition& getStartingPosition();
+    [[nodiscard]] static std::uint64_t getStartingPositionHash();
+};
@@ -0,0 +1,123 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+/// CONSTRUCTORS
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tickLength, Clock::time_point start) : tickLength{tickLength}, start{start} {
+    if (tickLength <= std::chrono::milliseconds::zero()) {
+        throw std::invalid_argument("Timer wheel tick length must be positive");
+    }
+    slotHeads.fill(noNode);
+}
+
+/// TIMERS
+
+TimerWheel::TimerId TimerWheel::arm(Clock::time_point deadline, std::uint64_t tag) {
+    // round up, so a timer never fires before its deadline
+    const auto sinceStart = std::max(deadline - start, Clock::duration::zero());
+    const auto ticks = static_cast<std::uint64_t>((sinceStart + tickLength - Clock::duration{1}) / tickLength);
+
+    std::uint32_t node;
+    if (freeNodes.empty()) {
+        node = static_cast<std::uint32_t>(nodes.size());
+        nodes.emplace_back();
+    } else {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    nodes[node].tag = tag;
+    nodes[node].expiryTick = std::max(ticks, currentTick);
+    ++nodes[node].generation; // even -> odd
+    link(node);
+    ++armedCount;
+    return (static_cast<TimerId>(nodes[node].generation) << 32) | node;
+}
+
+bool TimerWheel::cancel(TimerId timer) noexcept {
+    const auto node = static_cast<std::uint32_t>(timer & 0xFFFFFFFF);
+    const auto generation = static_cast<std::uint32_t>(timer >> 32);
+    if (node >= nodes.size() || nodes[node].generation != generation || (generation % 2) == 0) return false;
+
+    unlink(node);
+    ++nodes[node].generation; // odd -> even, so `timer` stops matching
+    freeNodes.push_back(node);
+    --armedCount;
+    return true;
+}
+
+void TimerWheel::advance(Clock::time_point now, const OnExpired& onExpired) {
+    if (now < start) return;
+    const auto nowTick = static_cast<std::uint64_t>((now - start) / tickLength);
+
+    for (; currentTick <= nowTick; ++currentTick) {
+        // each time a level wraps round, the next level's current slot is due to be spread over the levels below
+        if ((currentTick & slotMask) == 0) {
+            for (int level = 1; level < levelCount; ++level) {
+                cascade(level);
+                if (((currentTick >> (slotBits * level)) & slotMask) != 0) break;
+            }
+        }
+
+        // by index rather than reference: the callback may arm timers, which can reallocate `nodes`
+        const std::uint32_t slot = currentTick & slotMask;
+        while (slotHeads[slot] != noNode) {
+            const std::uint32_t node = slotHeads[slot];
+            const std::uint64_t tag = nodes[node].tag;
+            unlink(node);
+            ++nodes[node].generation;
+            freeNodes.push_back(node);
+            --armedCount;
+            onExpired(tag);
+        }
+    }
+}
+
+/// SLOTS
+
+void TimerWheel::link(std::uint32_t node) noexcept {
+    // timers further off than the top level reaches wait in its last slot and are looked at again once round
+    constexpr std::uint64_t reach = std::uint64_t{1} << (slotBits * levelCount);
+    const std::uint64_t placement = std::min(nodes[node].expiryTick, currentTick + reach - 1);
+    const std::uint64_t delta = placement - currentTick;
+
+    int level = 0;
+    while (level < levelCount - 1 && delta >= (std::uint64_t{1} << (slotBits * (level + 1)))) {
+        ++level;
+    }
+    const auto slot = static_cast<std::uint32_t>(level * slotCount + ((placement >> (slotBits * level)) & slotMask));
+
+    Node& linked = nodes[node];
+    linked.slot = slot;
+    linked.previous = noNode;
+    linked.next = slotHeads[slot];
+    if (linked.next != noNode) {
+        nodes[linked.next].previous = node;
+    }
+    slotHeads[slot] = node;
+}
+
+void TimerWheel::unlink(std::uint32_t node) noexcept {
+    Node& unlinked = nodes[node];
+    if (unlinked.previous != noNode) {
+        nodes[unlinked.previous].next = unlinked.next;
+    } else {
+        slotHeads[unlinked.slot] = unlinked.next;
+    }
+    if (unlinked.next != noNode) {
+        nodes[unlinked.next].previous = unlinked.previous;
+    }
+    unlinked.previous = unlinked.next = unlinked.slot = noNode;
+}
+
+void TimerWheel::cascade(int level) noexcept {
+    const auto slot = static_cast<std::uint32_t>(level * slotCount + ((currentTick >> (slotBits * level)) & slotMask));
+    std::uint32_t node = std::exchange(slotHeads[slot], noNode); // detached first, so nothing is relinked into it
+    while (node != noNode) {
+        const std::uint32_t next = nodes[node].next;
+        link(node);
+        node = next;
+    }
+}
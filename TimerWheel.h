@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/* Hierarchical timer wheel: any number of one-shot timers, each armed or cancelled in O(1), all expired by one
+ advance() call per tick however many there are.
+
+ Level 0 has a slot per tick for the next 256 ticks, level 1 a slot per 256 ticks for the next 256^2, and so on.
+ A timer goes in the coarsest slot that still tells it apart from now, and is moved down a level each time the level
+ below wraps round, so it is looked at O(levels) times in all rather than once per tick.
+
+ Timers never fire early: deadlines are rounded up to the next tick. Not thread-safe; one thread owns a wheel.
+*/
+class TimerWheel {
+public:
+    /// STRUCTS
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::uint64_t; // 0 is never a live timer
+    using OnExpired = std::function<void(std::uint64_t tag)>;
+
+private:
+    static constexpr int levelCount = 4;
+    static constexpr int slotBits = 8;
+    static constexpr std::uint32_t slotCount = 1 << slotBits;
+    static constexpr std::uint32_t slotMask = slotCount - 1;
+    static constexpr std::uint32_t noNode = 0xFFFFFFFF;
+
+    // Timers are nodes in a pool, linked into their slot's list by index
+    struct Node {
+        std::uint64_t tag {0};
+        std::uint64_t expiryTick {0};
+        std::uint32_t previous {noNode};
+        std::uint32_t next {noNode};
+        std::uint32_t generation {0}; // odd while armed, so ids of fired or cancelled timers are caught
+        std::uint32_t slot {noNode};  // level * slotCount + index, while armed
+    };
+
+    /// DATA MEMBERS
+    std::chrono::milliseconds tickLength;
+    Clock::time_point start;
+    std::uint64_t currentTick {0}; // the next tick advance() will expire
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> freeNodes;
+    std::array<std::uint32_t, levelCount * slotCount> slotHeads;
+    std::size_t armedCount {0};
+
+public:
+    /// CONSTRUCTORS
+    explicit TimerWheel(std::chrono::milliseconds tickLength = std::chrono::milliseconds{10}, Clock::time_point start = Clock::now());
+
+    /// TIMERS
+    // `tag` is handed back to advance()'s callback when the timer fires
+    [[nodiscard]] TimerId arm(Clock::time_point deadline, std::uint64_t tag);
+    bool cancel(TimerId timer) noexcept; // false if it has already fired or been cancelled
+
+    // Fires every timer due by `now`, in deadline order to the tick. `onExpired` may arm and cancel timers
+    void advance(Clock::time_point now, const OnExpired& onExpired);
+
+    /// GETTERS
+    [[nodiscard]] std::size_t size() const noexcept { return armedCount; }
+    [[nodiscard]] std::chrono::milliseconds getTickLength() const noexcept { return tickLength; }
+
+private:
+    void link(std::uint32_t node) noexcept;   // into the slot for its expiry tick
+    void unlink(std::uint32_t node) noexcept; // from its slot
+    void cascade(int level) noexcept;         // a level's current slot down into the levels below
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Piece.h"
+
+// SplitMix64 step, used to fill the key table below
+[[nodiscard]] constexpr std::uint64_t splitMix64(std::uint64_t& state) noexcept {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Random keys for Zobrist hashing: a position's hash is the XOR of the keys for each (piece, square) plus the side to
+ move, castling rights and en passant file. Generated at compile time from a fixed seed, so hashes are the same in
+ every build and can be written to disk (see Journal). */
+class Zobrist {
+    static constexpr std::size_t pieceSquareKeyCount = 12 * Location::getSquareCount();
+    static constexpr std::size_t keyCount = pieceSquareKeyCount + 1 + 4 + 8;
+
+    static constexpr std::array<std::uint64_t, keyCount> keys = [] {
+        std::array<std::uint64_t, keyCount> generated {};
+        std::uint64_t state = 0x4D43562D63686573ULL; // "MCV-ches"
+        for (auto& key : generated) key = splitMix64(state);
+        return generated;
+    }();
+
+public:
+    [[nodiscard]] static constexpr std::uint64_t pieceSquareKey(Piece::Colour colour, Piece::Type type, gsl::index squareIndex) noexcept {
+        const std::size_t piece = static_cast<std::size_t>(type) + (colour == Piece::Colour::BLACK ? 6 : 0);
+        return keys[piece * Location::getSquareCount() + static_cast<std::size_t>(squareIndex)];
+    }
+    [[nodiscard]] static constexpr std::uint64_t blackToMoveKey() noexcept { return keys[pieceSquareKeyCount]; }
+    // 0 = white king side, 1 = white queen side, 2 = black king side, 3 = black queen side
+    [[nodiscard]] static constexpr std::uint64_t castlingKey(std::size_t right) noexcept { return keys[pieceSquareKeyCount + 1 + right]; }
+    [[nodiscard]] static constexpr std::uint64_t enPassantFileKey(gsl::index column) noexcept {
+        return keys[pieceSquareKeyCount + 5 + static_cast<std::size_t>(column)];
+    }
+};
@@ -1,27 +1,112 @@
+#include "AnalysisCoordinator.h"
 #include "GameController.h"
+#include "GameViewOpenGL.h"
+#include "GameServer.h"
+#include "Perft.h"
+#include "PlayoutGenerator.h"
+#include <fstream>
 
-#include "glfw-3.3.8/include/GLFW/glfw3.h"
 #define GL_SILENCE_DEPRECATION
 
-/* -----------------------------------------------------------------------------
+// "<minutes>+<increment seconds>", eg. "5+3" or "0.5+0"
+static TimeControl parseTimeControl(std::string_view str) {
+    const std::size_t plus = str.find('+');
+    if (plus == std::string_view::npos) {
+        throw std::invalid_argument("Expected a time control like 5+3 (minutes + increment seconds)");
+    }
+    const std::chrono::duration<double> base {std::stod(std::string{str.substr(0, plus)}) * 60};
+    const std::chrono::duration<double> increment {std::stod(std::string{str.substr(plus + 1)})};
+    return TimeControl{
+        .base = std::chrono::duration_cast<std::chrono::milliseconds>(base),
+        .increment = std::chrono::duration_cast<std::chrono::milliseconds>(increment),
+    };
+}
+
+int main(int argc, char* argv[]) {
 
-IDEA - probably won't implement but thought it was fun
+    // `--serve <port|socket path> [journal dir] [--clock <minutes>+<increment seconds>]` hosts games for many clients;
+    // `--connect <port|socket path>` plays one by hand
+    if (argc >= 3 && argc <= 6 && std::string_view{argv[1]} == "--serve") {
+        GameServer server;
+        const char* journalDirectory = nullptr;
+        for (int i = 3; i < argc; ++i) {
+            const bool isClock = (std::string_view{argv[i]} == "--clock");
+            if ((isClock && i + 1 == argc) || (!isClock && journalDirectory != nullptr)) {
+                std::cerr << "Usage: " << argv[0] << " --serve <port|socket path> [journal dir] [--clock <minutes>+<increment seconds>]\n";
+                return EXIT_FAILURE;
+            }
+            if (isClock) {
+                server.enableClocks(parseTimeControl(argv[++i]));
+            } else {
+                journalDirectory = argv[i];
+            }
+        }
+        if (journalDirectory != nullptr) {
+            server.enableJournal(journalDirectory);
+        }
+        server.listen(argv[2]);
+        server.run();
+        return EXIT_SUCCESS;
+    }
+    if (argc == 3 && std::string_view{argv[1]} == "--connect") {
+        return runServerTestClient(argv[2]);
+    }
 
-struct SimpleMove {Location source, Location destination};
-struct CaptureMove {Location source, Location destination, bool enPassant};
-struct CastleMove {bool isKingside};
+    // `--perft <depth> [threads]` counts the move paths from the starting position, per root move then in total, after
+    // checking the move generator against published counts
+    if ((argc == 3 || argc == 4) && std::string_view{argv[1]} == "--perft") {
+        GameController controller {new GameViewCLI};
+        controller.setup();
+        const unsigned threadCount = (argc == 4 ? static_cast<unsigned>(std::stoul(argv[3])) : std::thread::hardware_concurrency());
+        Perft perft;
+        const std::vector<std::string> failures = perft.selfCheck(threadCount);
+        for (const std::string& failure : failures) {
+            std::cerr << "Self-check failed: " << failure << '\n';
+        }
+        if (!failures.empty()) return EXIT_FAILURE;
 
-class Move {
-    std::variant<SimpleMove, CaptureMove, CastleMove> details;
-public:
-    bool isSimpleMove() const {return details.index == 0;}
-    bool isCapturingMove() const {return details.index == 1;}
-    bool isCastlingMove() const {return details.index == 2;}
-};
+        const Perft::Result result = perft.run(controller, std::stoi(argv[2]), threadCount);
+        for (const auto& [move, nodes] : result.divide) {
+            std::cout << static_cast<std::string>(move) << ": " << nodes << '\n';
+        }
+        std::cout << "Nodes: " << result.nodes << std::endl;
+        return EXIT_SUCCESS;
+    }
 
------------------------------------------------------------------------------ */
+    // `--perft-processes <depth> <local workers> [listen address]` does the same over worker processes, which other
+    // boxes can add to with `--worker <coordinator address>`
+    if ((argc == 4 || argc == 5) && std::string_view{argv[1]} == "--perft-processes") {
+        AnalysisCoordinator coordinator;
+        coordinator.spawnWorkers(static_cast<unsigned>(std::stoul(argv[3])));
+        if (argc == 5) {
+            coordinator.listen(argv[4]);
+        }
+        GameController controller {new GameViewNone};
+        controller.setup();
+        const Perft::Result result = coordinator.perft(controller, std::stoi(argv[2]));
+        for (const auto& [move, nodes] : result.divide) {
+            std::cout << static_cast<std::string>(move) << ": " << nodes << '\n';
+        }
+        std::cout << "Nodes: " << result.nodes << std::endl;
+        return EXIT_SUCCESS;
+    }
+    if (argc == 3 && std::string_view{argv[1]} == "--worker") {
+        AnalysisCoordinator::runWorker(argv[2]);
+        return EXIT_SUCCESS;
+    }
 
-int main() {
+    // `--playouts <games> <output file> [seed]` writes random legal games, eg. for load tests
+    if ((argc == 4 || argc == 5) && std::string_view{argv[1]} == "--playouts") {
+        std::ofstream out {argv[3], std::ios::binary};
+        const PlayoutGenerator::Settings settings {
+            .seed = (argc == 5 ? std::stoull(argv[4]) : 0),
+            .gameCount = std::stoull(argv[2]),
+            .moveWeight = PlayoutGenerator::preferCaptures,
+        };
+        const PlayoutGenerator::Stats stats = PlayoutGenerator::generate(settings, out);
+        std::cout << stats.games << " games, " << stats.plies << " plies, " << stats.calcGamesPerSecond() << " games/s" << std::endl;
+        return EXIT_SUCCESS;
+    }
 
     GameController g {new GameViewOpenGL};
     g.setup();